@@ -0,0 +1,184 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "SizePolicy.h"
+
+// Blocked Bloom filter over hash codes, used to answer "definitely absent"
+// before a real lookup. A key maps to one 64-byte block and sets one bit in
+// each of the block's eight words, so a query reads a single cache line and
+// its eight word tests are independent (the loop vectorizes). The filter
+// cannot forget keys; its owner rebuilds it from the live keys once full()
+// reports it has taken the number it was sized for.
+class BlockedBloomFilter {
+public:
+    // A default-constructed filter is disabled and admits everything.
+    BlockedBloomFilter() : plannedBlocks(0), bitsPerKey(0), keyCapacity(0), insertedKeys(0) {}
+
+    // Room for expectedKeys at bitsPerKey bits each (rounded up to whole
+    // blocks). About 10 bits per key gives a 1% false-positive rate.
+    BlockedBloomFilter(size_t bitsPerKey, size_t expectedKeys)
+        : plannedBlocks(0), bitsPerKey(bitsPerKey), keyCapacity(0), insertedKeys(0) {
+        reset(expectedKeys);
+    }
+
+    BlockedBloomFilter(const BlockedBloomFilter& other)
+        : blocks(other.blocks), plannedBlocks(other.plannedBlocks), bitsPerKey(other.bitsPerKey), keyCapacity(other.keyCapacity),
+          insertedKeys(other.insertedKeys), rejected(other.rejectedQueries()) {}
+
+    BlockedBloomFilter& operator=(const BlockedBloomFilter& other) {
+        blocks = other.blocks;
+        plannedBlocks = other.plannedBlocks;
+        bitsPerKey = other.bitsPerKey;
+        keyCapacity = other.keyCapacity;
+        insertedKeys = other.insertedKeys;
+        rejected.store(other.rejectedQueries(), std::memory_order_relaxed);
+        return *this;
+    }
+
+    bool enabled() const {
+        return bitsPerKey != 0;
+    }
+
+    size_t bitsPerKeySetting() const {
+        return bitsPerKey;
+    }
+
+    // True once the filter holds as many keys as it was sized for.
+    bool full() const {
+        return insertedKeys >= keyCapacity;
+    }
+
+    // Keys left to insert before full().
+    size_t room() const {
+        return insertedKeys < keyCapacity ? keyCapacity - insertedKeys : 0;
+    }
+
+    // Empties the filter and resizes it for expectedKeys. The rejection count
+    // carries over.
+    void reset(size_t expectedKeys) {
+        blocks.assign(blockCountFor(expectedKeys), Block{});
+        plannedBlocks = blocks.size();
+        keyCapacity = expectedKeys;
+        insertedKeys = 0;
+    }
+
+    // Like reset(), but only reserves the blocks; buildBlocks() then clears
+    // them a few at a time, so that no single call touches the whole filter.
+    // The filter must not be used until unbuiltBlocks() reaches 0.
+    void plan(size_t expectedKeys) {
+        std::vector<Block>().swap(blocks);
+        plannedBlocks = blockCountFor(expectedKeys);
+        blocks.reserve(plannedBlocks);
+        keyCapacity = expectedKeys;
+        insertedKeys = 0;
+    }
+
+    void buildBlocks(size_t count) {
+        while (count > 0 && blocks.size() < plannedBlocks) {
+            blocks.emplace_back();
+            count--;
+        }
+    }
+
+    size_t unbuiltBlocks() const {
+        return plannedBlocks - blocks.size();
+    }
+
+    // Takes over the bits and sizing of other, e.g. a replacement built
+    // alongside this one, and leaves other disabled. The rejection count
+    // carries over, as in reset().
+    void replaceWith(BlockedBloomFilter&& other) {
+        blocks = std::move(other.blocks);
+        plannedBlocks = other.plannedBlocks;
+        bitsPerKey = other.bitsPerKey;
+        keyCapacity = other.keyCapacity;
+        insertedKeys = other.insertedKeys;
+        other.blocks.clear();
+        other.plannedBlocks = 0;
+        other.bitsPerKey = 0;
+        other.keyCapacity = 0;
+        other.insertedKeys = 0;
+    }
+
+    void insert(size_t hashCode) {
+        uint64_t h = mix(hashCode);
+        Block& block = blocks[blockOf(h)];
+        for (size_t i = 0; i < WORDS_PER_BLOCK; ++i) {
+            block.words[i] |= bitFor(h, i);
+        }
+        insertedKeys++;
+    }
+
+    // False means no key with this hash code was inserted.
+    bool mayContain(size_t hashCode) const {
+        uint64_t h = mix(hashCode);
+        const Block& block = blocks[blockOf(h)];
+        uint64_t missing = 0;
+        for (size_t i = 0; i < WORDS_PER_BLOCK; ++i) {
+            missing |= bitFor(h, i) & ~block.words[i];
+        }
+        return missing == 0;
+    }
+
+    // Counts a lookup the filter answered on its own. Callers may hold only a
+    // shared lock, so this is a relaxed load and store like CountingMetrics.
+    void recordRejection() const {
+        rejected.store(rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    size_t rejectedQueries() const {
+        return rejected.load(std::memory_order_relaxed);
+    }
+
+    size_t sizeInBytes() const {
+        return blocks.size() * sizeof(Block);
+    }
+
+private:
+    static constexpr size_t WORDS_PER_BLOCK = 8;
+    static constexpr size_t BLOCK_BITS = WORDS_PER_BLOCK * 64;
+
+    struct alignas(64) Block {
+        uint64_t words[WORDS_PER_BLOCK] = {};
+    };
+
+    std::vector<Block> blocks;
+    size_t plannedBlocks;
+    size_t bitsPerKey;
+    size_t keyCapacity;
+    size_t insertedKeys;
+    mutable std::atomic<size_t> rejected{0};
+
+    size_t blockCountFor(size_t expectedKeys) const {
+        size_t blockCount = (expectedKeys * bitsPerKey + BLOCK_BITS - 1) / BLOCK_BITS;
+        return blockCount > 0 ? blockCount : 1;
+    }
+
+    // std::hash leaves integers unchanged, so spread every code first.
+    static uint64_t mix(size_t hashCode) {
+        uint64_t h = static_cast<uint64_t>(hashCode);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // The high half picks the block, the low half picks the bits.
+    size_t blockOf(uint64_t h) const {
+        return static_cast<size_t>(sizing_detail::multiplyHigh(h, blocks.size()));
+    }
+
+    static uint64_t bitFor(uint64_t h, size_t word) {
+        static constexpr uint32_t SALTS[WORDS_PER_BLOCK] = {0x47B6137Bu, 0x44974D91u, 0x8824AD5Bu, 0xA2B7289Du,
+                                                            0x705495C7u, 0x2DF1424Bu, 0x9EFC4947u, 0x5C6BFB31u};
+        uint32_t salted = static_cast<uint32_t>(h) * SALTS[word];
+        return uint64_t{1} << (salted >> 26);
+    }
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef BOUNDEDHASHMAP_H
+#define BOUNDEDHASHMAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+#include "HashMap.h"
+
+// Counters reported by BoundedHashMap::stats().
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    double hitRate() const {
+        return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses);
+    }
+};
+
+// Fixed-capacity cache with CLOCK eviction. Entries live in a preallocated
+// slot array per shard and a HashMap indexes them by key, so a hit is one
+// index lookup plus setting the slot's reference bit: no allocation and no
+// list to relink. When a shard is full the clock hand sweeps its slots,
+// clearing reference bits, and evicts the first entry that was not used
+// since the previous sweep.
+//
+// Shards are locked independently as in ConcurrentHashMap. Readers hold only
+// a shared lock, since the reference bit is an atomic they may set
+// concurrently; insert and remove take the shard's exclusive lock. K and V
+// must be default constructible.
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class BoundedHashMap {
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    struct Slot {
+        K key;
+        V value;
+        mutable std::atomic<bool> referenced{false};
+    };
+
+    // Index nodes come from a pool, so an eviction followed by an insert
+    // recycles a node instead of going to the heap.
+    using Index = HashMap<K, uint32_t, Hash, KeyEqual, SeparateChaining, PrimeSizing,
+                          NodePoolAllocator<std::pair<K, uint32_t>>>;
+
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        mutable std::shared_mutex mutex;
+        Index index;
+        std::unique_ptr<Slot[]> slots;
+        size_t capacity = 0;
+        size_t used = 0;     // slots below used have held an entry
+        size_t hand = 0;
+        std::vector<uint32_t> freeSlots;
+        // Bumped by readers under the shared lock, hence atomic.
+        mutable std::atomic<size_t> hits{0};
+        mutable std::atomic<size_t> misses{0};
+        size_t evictions = 0;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    size_t shardCount;   // always a power of two
+    Hash hasher;
+
+    template <typename Q>
+    Shard& shardFor(const Q& key) const;
+
+    template <typename Q>
+    static bool lookup(const Shard& shard, const Q& key, V& valueOut);
+
+    // Slot for a new entry: a free one if any, else the CLOCK victim, whose
+    // index entry is dropped.
+    static uint32_t claimSlot(Shard& shard);
+
+public:
+    // Holds at most capacity entries across shardCount shards (rounded up to
+    // a power of two, and down to at most capacity).
+    explicit BoundedHashMap(size_t capacity, size_t shardCount = 16, const Hash& hasher = Hash(),
+                            const KeyEqual& keyEqual = KeyEqual());
+
+    BoundedHashMap(const BoundedHashMap&) = delete;
+
+    BoundedHashMap& operator=(const BoundedHashMap&) = delete;
+
+    // Adds or replaces key, evicting another entry of its shard when full.
+    void insert(const K& key, const V& value);
+
+    // Copies the cached value out and marks the entry as recently used.
+    bool search(const K& key, V& valueOut) const;
+
+    template <typename Q, typename = typename std::enable_if<supports_lookup_by<K, Q, Hash, KeyEqual>::value>::type>
+    bool search(const Q& key, V& valueOut) const;
+
+    bool remove(const K& key);
+
+    size_t size() const;
+
+    size_t capacity() const;
+
+    // Drops every entry; the counters are kept.
+    void clear();
+
+    CacheStats stats() const;
+
+    void printStats() const;
+};
+
+#include "BoundedHashMap.tpp"
+
+#endif
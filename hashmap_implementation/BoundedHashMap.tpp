@@ -0,0 +1,211 @@
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include "BoundedHashMap.h"
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+BoundedHashMap<K, V, Hash, KeyEqual>::BoundedHashMap(size_t capacity, size_t shardCount, const Hash& hasher,
+                                                     const KeyEqual& keyEqual)
+    : shardCount(1), hasher(hasher) {
+    if (capacity < 1) {
+        throw std::invalid_argument("Capacity must be positive.");
+    }
+    if (shardCount < 1) {
+        throw std::invalid_argument("Shard count must be positive.");
+    }
+    while (this->shardCount < shardCount) {
+        this->shardCount *= 2;
+    }
+    // Every shard needs at least one slot.
+    while (this->shardCount > capacity) {
+        this->shardCount /= 2;
+    }
+    if (capacity / this->shardCount >= UINT32_MAX) {
+        throw std::length_error("BoundedHashMap shards hold fewer than 2^32 entries.");
+    }
+
+    shards.reset(new Shard[this->shardCount]);
+    for (size_t i = 0; i < this->shardCount; ++i) {
+        Shard& shard = shards[i];
+        shard.capacity = capacity / this->shardCount + (i < capacity % this->shardCount ? 1 : 0);
+        shard.slots.reset(new Slot[shard.capacity]);
+        shard.freeSlots.reserve(shard.capacity);
+        shard.index = Index(1, hasher, keyEqual);
+        shard.index.reserve(shard.capacity);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename Q>
+typename BoundedHashMap<K, V, Hash, KeyEqual>::Shard& BoundedHashMap<K, V, Hash, KeyEqual>::shardFor(const Q& key) const {
+    // Same high-bit shard choice as ConcurrentHashMap, leaving the low bits
+    // to the shard's index.
+    uint64_t h = static_cast<uint64_t>(hashmap_detail::hashOf<K>(hasher, key)) * 0x9E3779B97F4A7C15ull;
+    return shards[static_cast<size_t>(h >> 32) & (shardCount - 1)];
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename Q>
+bool BoundedHashMap<K, V, Hash, KeyEqual>::lookup(const Shard& shard, const Q& key, V& valueOut) {
+    const uint32_t* slotIndex = shard.index.find(key);
+    if (slotIndex == nullptr) {
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const Slot& slot = shard.slots[*slotIndex];
+    // Hot entries already have the bit set; skipping the store keeps their
+    // cache line shared between readers.
+    if (!slot.referenced.load(std::memory_order_relaxed)) {
+        slot.referenced.store(true, std::memory_order_relaxed);
+    }
+    valueOut = slot.value;
+    shard.hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+uint32_t BoundedHashMap<K, V, Hash, KeyEqual>::claimSlot(Shard& shard) {
+    if (!shard.freeSlots.empty()) {
+        uint32_t slotIndex = shard.freeSlots.back();
+        shard.freeSlots.pop_back();
+        return slotIndex;
+    }
+    if (shard.used < shard.capacity) {
+        return static_cast<uint32_t>(shard.used++);
+    }
+
+    // Every slot is occupied. A referenced entry gets a second chance: its
+    // bit is cleared and the hand moves on. At most one full sweep is needed.
+    while (shard.slots[shard.hand].referenced.load(std::memory_order_relaxed)) {
+        shard.slots[shard.hand].referenced.store(false, std::memory_order_relaxed);
+        shard.hand = shard.hand + 1 == shard.capacity ? 0 : shard.hand + 1;
+    }
+    uint32_t victim = static_cast<uint32_t>(shard.hand);
+    shard.hand = shard.hand + 1 == shard.capacity ? 0 : shard.hand + 1;
+    shard.index.remove(shard.slots[victim].key);
+    shard.evictions++;
+    return victim;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void BoundedHashMap<K, V, Hash, KeyEqual>::insert(const K& key, const V& value) {
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    if (uint32_t* slotIndex = shard.index.find(key)) {
+        Slot& slot = shard.slots[*slotIndex];
+        slot.value = value;
+        slot.referenced.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    // New entries start unreferenced, so a one-off key is the first to go
+    // unless it is read again before the hand comes round.
+    uint32_t slotIndex = claimSlot(shard);
+    Slot& slot = shard.slots[slotIndex];
+    slot.key = key;
+    slot.value = value;
+    slot.referenced.store(false, std::memory_order_relaxed);
+    shard.index.insert(key, slotIndex);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool BoundedHashMap<K, V, Hash, KeyEqual>::search(const K& key, V& valueOut) const {
+    const Shard& shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return lookup(shard, key, valueOut);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename Q, typename>
+bool BoundedHashMap<K, V, Hash, KeyEqual>::search(const Q& key, V& valueOut) const {
+    const Shard& shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return lookup(shard, key, valueOut);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool BoundedHashMap<K, V, Hash, KeyEqual>::remove(const K& key) {
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    uint32_t* slotIndex = shard.index.find(key);
+    if (slotIndex == nullptr) {
+        return false;
+    }
+    uint32_t freed = *slotIndex;
+    shard.index.remove(key);
+
+    // Release whatever the entry owned now rather than when the slot is reused.
+    Slot& slot = shard.slots[freed];
+    slot.key = K();
+    slot.value = V();
+    slot.referenced.store(false, std::memory_order_relaxed);
+    shard.freeSlots.push_back(freed);
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+size_t BoundedHashMap<K, V, Hash, KeyEqual>::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < shardCount; ++i) {
+        std::shared_lock<std::shared_mutex> lock(shards[i].mutex);
+        total += shards[i].index.size();
+    }
+    return total;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+size_t BoundedHashMap<K, V, Hash, KeyEqual>::capacity() const {
+    size_t total = 0;
+    for (size_t i = 0; i < shardCount; ++i) {
+        total += shards[i].capacity;
+    }
+    return total;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void BoundedHashMap<K, V, Hash, KeyEqual>::clear() {
+    for (size_t i = 0; i < shardCount; ++i) {
+        Shard& shard = shards[i];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.index.clear();
+        for (size_t s = 0; s < shard.used; ++s) {
+            shard.slots[s].key = K();
+            shard.slots[s].value = V();
+            shard.slots[s].referenced.store(false, std::memory_order_relaxed);
+        }
+        shard.used = 0;
+        shard.hand = 0;
+        shard.freeSlots.clear();
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+CacheStats BoundedHashMap<K, V, Hash, KeyEqual>::stats() const {
+    CacheStats result;
+    for (size_t i = 0; i < shardCount; ++i) {
+        std::shared_lock<std::shared_mutex> lock(shards[i].mutex);
+        result.hits += shards[i].hits.load(std::memory_order_relaxed);
+        result.misses += shards[i].misses.load(std::memory_order_relaxed);
+        result.evictions += shards[i].evictions;
+        result.size += shards[i].index.size();
+        result.capacity += shards[i].capacity;
+    }
+    return result;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void BoundedHashMap<K, V, Hash, KeyEqual>::printStats() const {
+    CacheStats current = stats();
+    std::cout << "BoundedHashMap Statistics:" << std::endl;
+    std::cout << "  Number of Shards: " << shardCount << std::endl;
+    std::cout << "  Capacity: " << current.capacity << std::endl;
+    std::cout << "  Number of Elements: " << current.size << std::endl;
+    std::cout << "  Hits: " << current.hits << std::endl;
+    std::cout << "  Misses: " << current.misses << std::endl;
+    std::cout << "  Hit Rate: " << current.hitRate() << std::endl;
+    std::cout << "  Evictions: " << current.evictions << std::endl;
+}
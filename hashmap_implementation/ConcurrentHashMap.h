@@ -0,0 +1,58 @@
+#ifndef CONCURRENTHASHMAP_H
+#define CONCURRENTHASHMAP_H
+
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include "HashMap.h"
+
+// Thread-safe map that spreads keys over independently locked HashMap shards.
+// Readers take a shared lock on one shard only, and a shard that grows rehashes
+// under its own exclusive lock, so the other shards keep serving lookups.
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+          typename Layout = SeparateChaining>
+class ConcurrentHashMap {
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // Each shard starts on its own cache line so that lock traffic on one
+    // shard never invalidates its neighbours.
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        mutable std::shared_mutex mutex;
+        HashMap<K, V, Hash, KeyEqual, Layout> map;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    size_t shardCount;   // always a power of two
+    Hash hasher;
+
+    template <typename Q>
+    Shard& shardFor(const Q& key) const;
+
+public:
+    ConcurrentHashMap(size_t shardCount = 64, size_t initialShardCapacity = 101, const Hash& hasher = Hash(),
+                      const KeyEqual& keyEqual = KeyEqual());
+
+    ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+
+    ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+    void insert(const K& key, const V& value);
+
+    bool search(const K& key, V& valueOut) const;
+
+    template <typename Q, typename = typename std::enable_if<supports_lookup_by<K, Q, Hash, KeyEqual>::value>::type>
+    bool search(const Q& key, V& valueOut) const;
+
+    bool remove(const K& key);
+
+    size_t size() const;
+
+    void clear();
+
+    void printStats() const;
+};
+
+#include "ConcurrentHashMap.tpp"
+
+#endif
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include "ConcurrentHashMap.h"
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout>
+ConcurrentHashMap<K, V, Hash, KeyEqual, Layout>::ConcurrentHashMap(size_t shardCount, size_t initialShardCapacity,
+                                                                  const Hash& hasher, const KeyEqual& keyEqual)
+    : shardCount(1), hasher(hasher) {
+    if (shardCount < 1) {
+        throw std::invalid_argument("Shard count must be positive.");
+    }
+    while (this->shardCount < shardCount) {
+        this->shardCount *= 2;
+    }
+
+    shards.reset(new Shard[this->shardCount]);
+    for (size_t i = 0; i < this->shardCount; ++i) {
+        shards[i].map = HashMap<K, V, Hash, KeyEqual, Layout>(initialShardCapacity, hasher, keyEqual);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout>
+template <typename Q>
+typename ConcurrentHashMap<K, V, Hash, KeyEqual, Layout>::Shard& ConcurrentHashMap<K, V, Hash, KeyEqual, Layout>::shardFor(const Q& key) const {
+    // The shard map reduces the hash modulo its own capacity, which mostly
+    // consumes the low bits, so pick the shard from the high bits instead.
+    uint64_t h = static_cast<uint64_t>(hashmap_detail::hashOf<K>(hasher, key)) * 0x9E3779B97F4A7C15ull;
+    return shards[static_cast<size_t>(h >> 32) & (shardCount - 1)];
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout>
+void ConcurrentHashMap<K, V, Hash, KeyEqual, Layout>::insert(const K& key, const V& value) {
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.map.insert(key, value);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout>
+bool ConcurrentHashMap<K, V, Hash, KeyEqual, Layout>::search(const K& key, V& valueOut) const {
+    const Shard& shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.search(key, valueOut);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout>
+template <typename Q, typename>
+bool ConcurrentHashMap<K, V, Hash, KeyEqual, Layout>::search(const Q& key, V& valueOut) const {
+    const Shard& shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.search(key, valueOut);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout>
+bool ConcurrentHashMap<K, V, Hash, KeyEqual, Layout>::remove(const K& key) {
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.remove(key);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout>
+size_t ConcurrentHashMap<K, V, Hash, KeyEqual, Layout>::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < shardCount; ++i) {
+        std::shared_lock<std::shared_mutex> lock(shards[i].mutex);
+        total += shards[i].map.size();
+    }
+    return total;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout>
+void ConcurrentHashMap<K, V, Hash, KeyEqual, Layout>::clear() {
+    for (size_t i = 0; i < shardCount; ++i) {
+        std::unique_lock<std::shared_mutex> lock(shards[i].mutex);
+        shards[i].map.clear();
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout>
+void ConcurrentHashMap<K, V, Hash, KeyEqual, Layout>::printStats() const {
+    size_t total = 0;
+    size_t smallest = SIZE_MAX;
+    size_t largest = 0;
+
+    for (size_t i = 0; i < shardCount; ++i) {
+        std::shared_lock<std::shared_mutex> lock(shards[i].mutex);
+        size_t shardSize = shards[i].map.size();
+        total += shardSize;
+        smallest = std::min(smallest, shardSize);
+        largest = std::max(largest, shardSize);
+    }
+
+    std::cout << "ConcurrentHashMap Statistics:" << std::endl;
+    std::cout << "  Number of Shards: " << shardCount << std::endl;
+    std::cout << "  Number of Elements: " << total << std::endl;
+    std::cout << "  Smallest Shard: " << smallest << std::endl;
+    std::cout << "  Largest Shard: " << largest << std::endl;
+}
@@ -0,0 +1,178 @@
+#ifndef EPOCHRECLAIMER_H
+#define EPOCHRECLAIMER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Epoch-based reclamation shared by every lock-free structure in the process.
+//
+// A reader brackets its accesses with an EpochGuard, which publishes the
+// global epoch it observed in a slot owned by its thread. Writers unlink
+// memory, retire it tagged with the current epoch, and free it only once the
+// global epoch is two ahead of that tag: the epoch can only move forward while
+// every active reader has already observed it, so no reader can still hold a
+// pointer to the retired memory by then.
+class EpochDomain {
+public:
+    static EpochDomain& global() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    uint64_t currentEpoch() const {
+        return epoch.load(std::memory_order_acquire);
+    }
+
+    // Advance the global epoch if every active reader has caught up to it.
+    bool tryAdvance() {
+        uint64_t current = epoch.load(std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (Record* record = records.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+            uint64_t observed = record->epoch.load(std::memory_order_seq_cst);
+            if (observed != QUIESCENT && observed != current) {
+                return false;
+            }
+        }
+        return epoch.compare_exchange_strong(current, current + 1);
+    }
+
+    void enter() {
+        Record* record = localRecord();
+        if (record->nesting++ == 0) {
+            record->epoch.store(epoch.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+            // A seq_cst store may still be reordered after a later acquire
+            // load (ARMv8.3 LDAPR, POWER), which would let the reader pick up
+            // a pointer tryAdvance() does not see it protecting. The fence
+            // pairs with the one in tryAdvance() to rule that out.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void exit() {
+        Record* record = localRecord();
+        if (--record->nesting == 0) {
+            record->epoch.store(QUIESCENT, std::memory_order_release);
+        }
+    }
+
+private:
+    static constexpr uint64_t QUIESCENT = 0;
+
+    // One per thread, padded so that announcing an epoch only ever writes to a
+    // cache line no other thread writes. Records are recycled, never freed.
+    struct alignas(64) Record {
+        std::atomic<uint64_t> epoch{QUIESCENT};
+        std::atomic<bool> inUse{true};
+        unsigned nesting = 0;
+        Record* next = nullptr;
+    };
+
+    struct ThreadHandle {
+        Record* record = nullptr;
+
+        ~ThreadHandle() {
+            if (record != nullptr) {
+                record->inUse.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    std::atomic<uint64_t> epoch{1};
+    std::atomic<Record*> records{nullptr};
+
+    EpochDomain() = default;
+
+    Record* localRecord() {
+        static thread_local ThreadHandle handle;
+        if (handle.record == nullptr) {
+            handle.record = acquireRecord();
+        }
+        return handle.record;
+    }
+
+    Record* acquireRecord() {
+        for (Record* record = records.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+            bool expected = false;
+            if (!record->inUse.load(std::memory_order_relaxed) &&
+                record->inUse.compare_exchange_strong(expected, true)) {
+                return record;
+            }
+        }
+
+        Record* record = new Record();
+        Record* head = records.load(std::memory_order_relaxed);
+        do {
+            record->next = head;
+        } while (!records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+        return record;
+    }
+};
+
+// Scoped read-side critical section.
+class EpochGuard {
+public:
+    EpochGuard() { EpochDomain::global().enter(); }
+    ~EpochGuard() { EpochDomain::global().exit(); }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+// Memory retired by one writer, waiting for readers to move past it. Not
+// thread-safe: callers serialize writers themselves.
+class RetireList {
+public:
+    RetireList() = default;
+
+    RetireList(const RetireList&) = delete;
+    RetireList& operator=(const RetireList&) = delete;
+
+    ~RetireList() {
+        for (const Retired& item : items) {
+            item.deleter(item.ptr);
+        }
+    }
+
+    template <typename T>
+    void retire(T* ptr) {
+        items.push_back({EpochDomain::global().currentEpoch(), ptr, [](void* p) { delete static_cast<T*>(p); }});
+    }
+
+    void retire(void* ptr, void (*deleter)(void*)) {
+        items.push_back({EpochDomain::global().currentEpoch(), ptr, deleter});
+    }
+
+    // Free everything no reader can still see.
+    void collect() {
+        EpochDomain& domain = EpochDomain::global();
+        domain.tryAdvance();
+        uint64_t safeBefore = domain.currentEpoch();
+
+        size_t kept = 0;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (items[i].epoch + 2 <= safeBefore) {
+                items[i].deleter(items[i].ptr);
+            } else {
+                items[kept++] = items[i];
+            }
+        }
+        items.resize(kept);
+    }
+
+    size_t pending() const {
+        return items.size();
+    }
+
+private:
+    struct Retired {
+        uint64_t epoch;
+        void* ptr;
+        void (*deleter)(void*);
+    };
+
+    std::vector<Retired> items;
+};
+
+#endif
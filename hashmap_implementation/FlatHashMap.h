@@ -0,0 +1,163 @@
+#ifndef FLATHASHMAP_H
+#define FLATHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include "HashMap.h"
+
+namespace flat_detail {
+
+// A window of 16 control bytes that can be matched in one instruction.
+class Group {
+public:
+    static constexpr size_t WIDTH = 16;
+
+    explicit Group(const int8_t* pos);
+
+    // Bit i is set when byte i equals h2 / is empty.
+    uint32_t match(int8_t h2) const;
+    uint32_t matchEmpty() const;
+
+private:
+    const int8_t* bytes;
+};
+
+unsigned countTrailingZeros(uint32_t mask);
+
+}
+
+// Open-addressing layout: entries live in one flat array next to a parallel
+// array of control bytes. A control byte is either EMPTY or the low 7 bits of
+// the entry's hash, so a lookup rejects 16 slots at a time before it touches a
+// key. Probing is linear and remove() shifts the rest of the run back into the
+// hole, so the table never accumulates tombstones. Capacities are always powers
+// of two, so the SizePolicy argument is accepted but not used; neither is
+// Allocator, since there are no per-entry nodes to pool.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+class HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics> {
+private:
+    static constexpr double LOAD_FACTOR_THRESHOLD = 0.875;
+    static constexpr int8_t EMPTY = -128;
+
+    using Entry = std::pair<K, V>;
+
+    // capacity + Group::WIDTH bytes; the tail mirrors the first group so a
+    // probe window that wraps around can still be loaded in one piece.
+    int8_t* ctrl;
+    Entry* slots;
+    size_t capacity;
+    size_t numElements;
+    Hash hasher;
+    KeyEqual keyEqual;
+    Metrics metrics;
+
+    template <typename Q>
+    size_t hash(const Q& key) const;
+
+    size_t homeOf(size_t hashValue) const;
+
+    // Index of the slot holding key, or capacity when it is absent.
+    template <typename Q>
+    size_t findIndex(const Q& key, size_t hashValue) const;
+
+    // As above, adding the number of control groups examined to probes.
+    template <typename Q>
+    size_t findIndex(const Q& key, size_t hashValue, size_t& probes) const;
+
+    // findIndex() on behalf of a caller's find/search, reported to metrics.
+    template <typename Q>
+    size_t recordedFindIndex(const Q& key, size_t hashValue) const;
+
+    size_t findEmpty(size_t hashValue) const;
+
+    void setCtrl(size_t index, int8_t value);
+
+    void allocate(size_t newCapacity);
+
+    void release();
+
+    void rehash(size_t newCapacity);
+
+    void resizeAndRehash();
+
+    // Constructs a new entry for a key known to be absent, growing first if needed.
+    template <typename KeyArg, typename... Args>
+    std::pair<V*, bool> emplaceNew(size_t hashValue, KeyArg&& key, Args&&... args);
+
+public:
+    HashMap(size_t initialCapacity = 101, const Hash& hasher = Hash(), const KeyEqual& keyEqual = KeyEqual(),
+            const Allocator& allocator = Allocator());
+
+    template <typename InputIt, typename Extract = hashmap_detail::Identity,
+              typename = typename std::iterator_traits<InputIt>::iterator_category>
+    HashMap(InputIt first, InputIt last, Extract extract = Extract(), const Hash& hasher = Hash(),
+            const KeyEqual& keyEqual = KeyEqual(), const Allocator& allocator = Allocator());
+
+    HashMap(const HashMap& other);
+
+    HashMap(HashMap&& other) noexcept;
+
+    HashMap& operator=(HashMap other);
+
+    ~HashMap();
+
+    void reserve(size_t count);
+
+    void insert(const K& key, const V& value);
+
+    template <typename... Args>
+    std::pair<V*, bool> emplace(Args&&... args);
+
+    template <typename... Args>
+    std::pair<V*, bool> try_emplace(const K& key, Args&&... args);
+
+    template <typename... Args>
+    std::pair<V*, bool> try_emplace(K&& key, Args&&... args);
+
+    template <typename M>
+    std::pair<V*, bool> insert_or_assign(const K& key, M&& value);
+
+    template <typename M>
+    std::pair<V*, bool> insert_or_assign(K&& key, M&& value);
+
+    bool search(const K& key, V& valueOut) const;
+
+    V* find(const K& key);
+
+    const V* find(const K& key) const;
+
+    template <typename Q, typename = typename std::enable_if<supports_lookup_by<K, Q, Hash, KeyEqual>::value>::type>
+    const V* find(const Q& key) const;
+
+    template <typename Q, typename = typename std::enable_if<supports_lookup_by<K, Q, Hash, KeyEqual>::value>::type>
+    bool search(const Q& key, V& valueOut) const;
+
+    bool search(const char* key, size_t length, V& valueOut) const;
+
+    size_t searchBatch(const K* keys, size_t count, const V** out) const;
+
+    bool remove(const K& key);
+
+    FrozenHashMap<K, V, Hash, KeyEqual> freeze() const;
+
+    void save(const std::string& path) const;
+
+    static MappedHashMap mapFile(const std::string& path);
+
+    HashMapStats stats() const;
+
+    size_t size() const;
+
+    void clear();
+
+    void printStats() const;
+};
+
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+using FlatHashMap = HashMap<K, V, Hash, KeyEqual, OpenAddressing>;
+
+#include "FlatHashMap.tpp"
+
+#endif
@@ -0,0 +1,544 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include "FlatHashMap.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_HASHMAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace flat_detail {
+
+inline Group::Group(const int8_t* pos) : bytes(pos) {}
+
+#ifdef FLAT_HASHMAP_SSE2
+inline uint32_t Group::match(int8_t h2) const {
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2))));
+}
+
+inline uint32_t Group::matchEmpty() const {
+    // EMPTY is the only control value with the sign bit set.
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+    return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+}
+#else
+inline uint32_t Group::match(int8_t h2) const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < WIDTH; ++i) {
+        if (bytes[i] == h2) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+inline uint32_t Group::matchEmpty() const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < WIDTH; ++i) {
+        if (bytes[i] < 0) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+#endif
+
+inline unsigned countTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename Q>
+size_t HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::hash(const Q& key) const {
+    // std::hash is the identity for integers on common standard libraries, so
+    // spread the bits before splitting them into a position and a tag.
+    uint64_t h = static_cast<uint64_t>(hashmap_detail::hashOf<K>(hasher, key)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(h ^ (h >> 32));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+size_t HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::homeOf(size_t hashValue) const {
+    return (hashValue >> 7) & (capacity - 1);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename Q>
+size_t HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::findIndex(const Q& key, size_t hashValue) const {
+    size_t probes = 0;
+    return findIndex(key, hashValue, probes);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename Q>
+size_t HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::recordedFindIndex(const Q& key, size_t hashValue) const {
+    size_t probes = 0;
+    size_t index = findIndex(key, hashValue, probes);
+    metrics.recordLookup(index != capacity, probes);
+    return index;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename Q>
+size_t HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::findIndex(const Q& key, size_t hashValue, size_t& probes) const {
+    if (numElements == 0) {
+        return capacity;
+    }
+
+    const int8_t h2 = static_cast<int8_t>(hashValue & 0x7F);
+    size_t pos = homeOf(hashValue);
+
+    while (true) {
+        probes++;
+        flat_detail::Group group(ctrl + pos);
+        uint32_t empties = group.matchEmpty();
+        uint32_t candidates = group.match(h2);
+        if (empties) {
+            // A key is never stored past the first empty slot of its run.
+            candidates &= (empties & (0u - empties)) - 1;
+        }
+
+        while (candidates) {
+            size_t index = (pos + flat_detail::countTrailingZeros(candidates)) & (capacity - 1);
+            if (hashmap_detail::keysEqual(keyEqual, slots[index].first, key)) {
+                return index;
+            }
+            candidates &= candidates - 1;
+        }
+
+        if (empties) {
+            return capacity;
+        }
+        pos = (pos + flat_detail::Group::WIDTH) & (capacity - 1);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+size_t HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::findEmpty(size_t hashValue) const {
+    size_t pos = homeOf(hashValue);
+    while (true) {
+        uint32_t empties = flat_detail::Group(ctrl + pos).matchEmpty();
+        if (empties) {
+            return (pos + flat_detail::countTrailingZeros(empties)) & (capacity - 1);
+        }
+        pos = (pos + flat_detail::Group::WIDTH) & (capacity - 1);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::setCtrl(size_t index, int8_t value) {
+    ctrl[index] = value;
+    if (index < flat_detail::Group::WIDTH) {
+        ctrl[capacity + index] = value;
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::allocate(size_t newCapacity) {
+    capacity = newCapacity;
+    ctrl = new int8_t[capacity + flat_detail::Group::WIDTH];
+    std::memset(ctrl, EMPTY, capacity + flat_detail::Group::WIDTH);
+    slots = std::allocator<Entry>().allocate(capacity);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::release() {
+    if (ctrl == nullptr) {
+        return;
+    }
+    for (size_t i = 0; i < capacity; ++i) {
+        if (ctrl[i] != EMPTY) {
+            slots[i].~Entry();
+        }
+    }
+    std::allocator<Entry>().deallocate(slots, capacity);
+    delete[] ctrl;
+    ctrl = nullptr;
+    slots = nullptr;
+    capacity = 0;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::HashMap(size_t initialCapacity, const Hash& hasher,
+                                                                              const KeyEqual& keyEqual, const Allocator&)
+    : ctrl(nullptr), slots(nullptr), capacity(0), numElements(0), hasher(hasher), keyEqual(keyEqual) {
+    if (initialCapacity < 1) {
+        throw std::invalid_argument("Capacity must be positive.");
+    }
+    size_t powerOfTwo = flat_detail::Group::WIDTH;
+    while (powerOfTwo < initialCapacity) {
+        powerOfTwo *= 2;
+    }
+    allocate(powerOfTwo);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename InputIt, typename Extract, typename>
+HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::HashMap(InputIt first, InputIt last, Extract extract, const Hash& hasher,
+                                                                              const KeyEqual& keyEqual, const Allocator& allocator)
+    : HashMap(1, hasher, keyEqual, allocator) {
+    hashmap_detail::bulkInsert(*this, first, last, extract);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::HashMap(const HashMap& other)
+    : ctrl(nullptr), slots(nullptr), capacity(0), numElements(0), hasher(other.hasher), keyEqual(other.keyEqual),
+      metrics(other.metrics) {
+    if (other.ctrl == nullptr) {
+        return;
+    }
+    allocate(other.capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        if (other.ctrl[i] != EMPTY) {
+            new (slots + i) Entry(other.slots[i]);
+            setCtrl(i, other.ctrl[i]);
+            numElements++;
+        }
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::HashMap(HashMap&& other) noexcept
+    : ctrl(other.ctrl), slots(other.slots), capacity(other.capacity), numElements(other.numElements),
+      hasher(other.hasher), keyEqual(other.keyEqual), metrics(other.metrics) {
+    other.ctrl = nullptr;
+    other.slots = nullptr;
+    other.capacity = 0;
+    other.numElements = 0;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>& HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::operator=(HashMap other) {
+    std::swap(ctrl, other.ctrl);
+    std::swap(slots, other.slots);
+    std::swap(capacity, other.capacity);
+    std::swap(numElements, other.numElements);
+    std::swap(hasher, other.hasher);
+    std::swap(keyEqual, other.keyEqual);
+    std::swap(metrics, other.metrics);
+    return *this;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::~HashMap() {
+    release();
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::rehash(size_t newCapacity) {
+    int8_t* oldCtrl = ctrl;
+    Entry* oldSlots = slots;
+    size_t oldCapacity = capacity;
+
+    allocate(newCapacity);
+
+    for (size_t i = 0; i < oldCapacity; ++i) {
+        if (oldCtrl[i] != EMPTY) {
+            size_t h = hash(oldSlots[i].first);
+            size_t index = findEmpty(h);
+            new (slots + index) Entry(std::move(oldSlots[i]));
+            setCtrl(index, oldCtrl[i]);
+            oldSlots[i].~Entry();
+        }
+    }
+
+    if (oldCtrl != nullptr) {
+        std::allocator<Entry>().deallocate(oldSlots, oldCapacity);
+        delete[] oldCtrl;
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::resizeAndRehash() {
+    auto timer = metrics.startTimer();
+    rehash(std::max(flat_detail::Group::WIDTH, capacity * 2));
+    metrics.recordRehash(timer);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::reserve(size_t count) {
+    size_t newCapacity = std::max(flat_detail::Group::WIDTH, capacity);
+    while (static_cast<double>(count) / newCapacity > LOAD_FACTOR_THRESHOLD) {
+        newCapacity *= 2;
+    }
+    if (newCapacity != capacity) {
+        auto timer = metrics.startTimer();
+        rehash(newCapacity);
+        metrics.recordRehash(timer);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename KeyArg, typename... Args>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::emplaceNew(size_t hashValue, KeyArg&& key, Args&&... args) {
+    if (static_cast<double>(numElements + 1) / capacity > LOAD_FACTOR_THRESHOLD) {
+        resizeAndRehash();
+    }
+
+    size_t index = findEmpty(hashValue);
+    new (slots + index) Entry(std::piecewise_construct,
+                              std::forward_as_tuple(std::forward<KeyArg>(key)),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+    setCtrl(index, static_cast<int8_t>(hashValue & 0x7F));
+    numElements++;
+    metrics.recordInsert();
+    return {&slots[index].second, true};
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::insert(const K& key, const V& value) {
+    insert_or_assign(key, value);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename... Args>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::emplace(Args&&... args) {
+    Entry entry(std::forward<Args>(args)...);
+    size_t h = hash(entry.first);
+    size_t index = findIndex(entry.first, h);
+    if (index != capacity) {
+        return {&slots[index].second, false};
+    }
+    return emplaceNew(h, std::move(entry.first), std::move(entry.second));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename... Args>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::try_emplace(const K& key, Args&&... args) {
+    size_t h = hash(key);
+    size_t index = findIndex(key, h);
+    if (index != capacity) {
+        return {&slots[index].second, false};
+    }
+    return emplaceNew(h, key, std::forward<Args>(args)...);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename... Args>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::try_emplace(K&& key, Args&&... args) {
+    size_t h = hash(key);
+    size_t index = findIndex(key, h);
+    if (index != capacity) {
+        return {&slots[index].second, false};
+    }
+    return emplaceNew(h, std::move(key), std::forward<Args>(args)...);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename M>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::insert_or_assign(const K& key, M&& value) {
+    size_t h = hash(key);
+    size_t index = findIndex(key, h);
+    if (index != capacity) {
+        slots[index].second = std::forward<M>(value);
+        metrics.recordUpdate();
+        return {&slots[index].second, false};
+    }
+    return emplaceNew(h, key, std::forward<M>(value));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename M>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::insert_or_assign(K&& key, M&& value) {
+    size_t h = hash(key);
+    size_t index = findIndex(key, h);
+    if (index != capacity) {
+        slots[index].second = std::forward<M>(value);
+        metrics.recordUpdate();
+        return {&slots[index].second, false};
+    }
+    return emplaceNew(h, std::move(key), std::forward<M>(value));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+V* HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::find(const K& key) {
+    size_t index = recordedFindIndex(key, hash(key));
+    return index != capacity ? &slots[index].second : nullptr;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+const V* HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::find(const K& key) const {
+    size_t index = recordedFindIndex(key, hash(key));
+    return index != capacity ? &slots[index].second : nullptr;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename Q, typename>
+const V* HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::find(const Q& key) const {
+    size_t index = recordedFindIndex(key, hash(key));
+    return index != capacity ? &slots[index].second : nullptr;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+bool HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::search(const K& key, V& valueOut) const {
+    size_t index = recordedFindIndex(key, hash(key));
+    if (index == capacity) {
+        return false;
+    }
+    valueOut = slots[index].second;
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename Q, typename>
+bool HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::search(const Q& key, V& valueOut) const {
+    size_t index = recordedFindIndex(key, hash(key));
+    if (index == capacity) {
+        return false;
+    }
+    valueOut = slots[index].second;
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+bool HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::search(const char* key, size_t length, V& valueOut) const {
+    return search(std::string_view(key, length), valueOut);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+size_t HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::searchBatch(const K* keys, size_t count, const V** out) const {
+    size_t hashes[hashmap_detail::BATCH_GROUP_SIZE];
+    size_t found = 0;
+
+    for (size_t base = 0; base < count; base += hashmap_detail::BATCH_GROUP_SIZE) {
+        size_t groupSize = std::min(hashmap_detail::BATCH_GROUP_SIZE, count - base);
+
+        for (size_t i = 0; i < groupSize; ++i) {
+            hashes[i] = hash(keys[base + i]);
+            if (capacity != 0) {
+                size_t home = homeOf(hashes[i]);
+                hashmap_detail::prefetchForRead(ctrl + home);
+                hashmap_detail::prefetchForRead(slots + home);
+            }
+        }
+
+        for (size_t i = 0; i < groupSize; ++i) {
+            size_t index = recordedFindIndex(keys[base + i], hashes[i]);
+            out[base + i] = index != capacity ? &slots[index].second : nullptr;
+            if (index != capacity) {
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+bool HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::remove(const K& key) {
+    size_t hole = findIndex(key, hash(key));
+    if (hole == capacity) {
+        return false;
+    }
+    slots[hole].~Entry();
+    numElements--;
+    metrics.recordRemove();
+
+    // Backward-shift deletion: pull later entries of the run into the hole
+    // unless that would move them in front of their home slot.
+    size_t mask = capacity - 1;
+    size_t next = (hole + 1) & mask;
+    while (ctrl[next] != EMPTY) {
+        size_t home = homeOf(hash(slots[next].first));
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            new (slots + hole) Entry(std::move(slots[next]));
+            slots[next].~Entry();
+            setCtrl(hole, ctrl[next]);
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    setCtrl(hole, EMPTY);
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+FrozenHashMap<K, V, Hash, KeyEqual> HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::freeze() const {
+    std::vector<std::pair<K, V>> entries;
+    entries.reserve(numElements);
+    for (size_t i = 0; i < capacity; ++i) {
+        if (ctrl[i] != EMPTY) {
+            entries.push_back(slots[i]);
+        }
+    }
+    return FrozenHashMap<K, V, Hash, KeyEqual>(std::move(entries), hasher, keyEqual);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+HashMapStats HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::stats() const {
+    HashMapStats result;
+    metrics.fill(result);
+    result.size = numElements;
+    result.capacity = capacity;
+    result.loadFactor = capacity == 0 ? 0.0 : static_cast<double>(numElements) / capacity;
+    return result;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+size_t HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::size() const {
+    return numElements;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::clear() {
+    for (size_t i = 0; i < capacity; ++i) {
+        if (ctrl[i] != EMPTY) {
+            slots[i].~Entry();
+        }
+    }
+    if (ctrl != nullptr) {
+        std::memset(ctrl, EMPTY, capacity + flat_detail::Group::WIDTH);
+    }
+    numElements = 0;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::printStats() const {
+    std::cout << "HashMap Statistics (open addressing):" << std::endl;
+    std::cout << "  Current Capacity: " << capacity << std::endl;
+    std::cout << "  Number of Elements: " << numElements << std::endl;
+    if (capacity == 0) {
+        return;
+    }
+    std::cout << "  Load Factor: " << static_cast<double>(numElements) / capacity << std::endl;
+
+    size_t totalProbeLength = 0;
+    size_t longestProbe = 0;
+    size_t emptySlots = 0;
+
+    for (size_t i = 0; i < capacity; ++i) {
+        if (ctrl[i] == EMPTY) {
+            emptySlots++;
+            continue;
+        }
+        size_t distance = (i - homeOf(hash(slots[i].first))) & (capacity - 1);
+        totalProbeLength += distance + 1;
+        if (distance + 1 > longestProbe) {
+            longestProbe = distance + 1;
+        }
+    }
+
+    double averageProbe = numElements ? static_cast<double>(totalProbeLength) / numElements : 0.0;
+    std::cout << "  Average Probe Length: " << averageProbe << std::endl;
+    std::cout << "  Longest Probe Length: " << longestProbe << std::endl;
+    std::cout << "  Number of Empty Slots: " << emptySlots << std::endl;
+    std::cout << "  Bytes per Element: "
+              << (numElements ? static_cast<double>(capacity * (sizeof(Entry) + 1)) / numElements : 0.0)
+              << std::endl;
+    if constexpr (Metrics::ENABLED) {
+        std::cout << "  Metrics: " << stats().toJson() << std::endl;
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef FROZENHASHMAP_H
+#define FROZENHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "HashMap.h"
+
+// Immutable map over a fixed key set, built by HashMap::freeze(). Keys are
+// placed with a minimal perfect hash in the CHD (hash, displace) style: every
+// key hashes to a small bucket, and each bucket stores the displacement seed
+// that sends all of its keys to distinct slots of one contiguous n-slot array.
+// A lookup is therefore one bucket read plus exactly one slot probe. Each slot
+// also keeps a 16-bit fingerprint of its key's hash, so almost every absent
+// key is rejected without comparing keys.
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class FrozenHashMap {
+private:
+    // Average keys per bucket. Larger buckets shrink the seed array but take
+    // longer to place.
+    static constexpr size_t KEYS_PER_BUCKET = 4;
+
+    // Seeds with this bit set name their single key's slot directly.
+    static constexpr uint32_t DIRECT_SLOT = 0x80000000u;
+
+    // The fingerprint sits next to its key so a rejected lookup touches no
+    // more memory than an accepted one, and the value follows in the same
+    // entry so a hit costs one slot read.
+    struct Slot {
+        uint16_t fingerprint;
+        K key;
+        V value;
+    };
+
+    std::vector<uint32_t> seeds;
+    std::vector<Slot> slots;
+    Hash hasher;
+    KeyEqual keyEqual;
+
+    static uint64_t mix(uint64_t h);
+
+    template <typename Q>
+    uint64_t hash(const Q& key) const;
+
+    size_t bucketOf(uint64_t h) const;
+
+    static size_t slotOf(uint64_t h, uint32_t seed, size_t slotCount);
+
+    // Slot that would hold key, or size() when the fingerprint already rules
+    // it out.
+    size_t candidateSlot(uint64_t h) const;
+
+    template <typename Q>
+    const V* lookup(const Q& key) const;
+
+public:
+    FrozenHashMap(const Hash& hasher = Hash(), const KeyEqual& keyEqual = KeyEqual());
+
+    // Keys must be distinct. Throws std::runtime_error if two keys share a
+    // full hash code, since no seed can separate them.
+    explicit FrozenHashMap(std::vector<std::pair<K, V>> entries, const Hash& hasher = Hash(),
+                           const KeyEqual& keyEqual = KeyEqual());
+
+    const V* find(const K& key) const;
+
+    template <typename Q, typename = typename std::enable_if<supports_lookup_by<K, Q, Hash, KeyEqual>::value>::type>
+    const V* find(const Q& key) const;
+
+    bool search(const K& key, V& valueOut) const;
+
+    template <typename Q, typename = typename std::enable_if<supports_lookup_by<K, Q, Hash, KeyEqual>::value>::type>
+    bool search(const Q& key, V& valueOut) const;
+
+    // Fingerprint-only test: false means key is certainly absent, true means
+    // it is present apart from a 1 in 65536 chance. Never compares keys.
+    bool mayContain(const K& key) const;
+
+    template <typename Q, typename = typename std::enable_if<supports_lookup_by<K, Q, Hash, KeyEqual>::value>::type>
+    bool mayContain(const Q& key) const;
+
+    size_t size() const;
+
+    void printStats() const;
+};
+
+#include "FrozenHashMap.tpp"
+
+#endif
@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include "FrozenHashMap.h"
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+uint64_t FrozenHashMap<K, V, Hash, KeyEqual>::mix(uint64_t h) {
+    // splitmix64 finalizer.
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBull;
+    h ^= h >> 31;
+    return h;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename Q>
+uint64_t FrozenHashMap<K, V, Hash, KeyEqual>::hash(const Q& key) const {
+    return mix(static_cast<uint64_t>(hashmap_detail::hashOf<K>(hasher, key)));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+size_t FrozenHashMap<K, V, Hash, KeyEqual>::bucketOf(uint64_t h) const {
+    // Skewed: squaring a uniform value makes bucket b of r receive keys in
+    // proportion to 1/sqrt(b/r), so the first 30% of the buckets take about
+    // 55% of the keys. Those crowded buckets get placed while the table is
+    // still mostly empty, which leaves small buckets for the end when free
+    // slots are scarce. Unlike a two-range split there is no branch to
+    // mispredict on the lookup path.
+    uint64_t spread = h * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(sizing_detail::multiplyHigh(sizing_detail::multiplyHigh(spread, spread), seeds.size()));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+size_t FrozenHashMap<K, V, Hash, KeyEqual>::slotOf(uint64_t h, uint32_t seed, size_t slotCount) {
+    return static_cast<size_t>(sizing_detail::multiplyHigh(mix(h ^ (seed * 0x9E3779B97F4A7C15ull)), slotCount));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+size_t FrozenHashMap<K, V, Hash, KeyEqual>::candidateSlot(uint64_t h) const {
+    if (slots.empty()) {
+        return 0;
+    }
+    uint32_t seed = seeds[bucketOf(h)];
+    size_t slot = (seed & DIRECT_SLOT) != 0 ? seed & ~DIRECT_SLOT : slotOf(h, seed, slots.size());
+    return slots[slot].fingerprint == static_cast<uint16_t>(h) ? slot : slots.size();
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+FrozenHashMap<K, V, Hash, KeyEqual>::FrozenHashMap(const Hash& hasher, const KeyEqual& keyEqual)
+    : seeds(1, 0), hasher(hasher), keyEqual(keyEqual) {}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+FrozenHashMap<K, V, Hash, KeyEqual>::FrozenHashMap(std::vector<std::pair<K, V>> entries, const Hash& hasher,
+                                                   const KeyEqual& keyEqual)
+    : hasher(hasher), keyEqual(keyEqual) {
+    size_t n = entries.size();
+    if (n >= DIRECT_SLOT) {
+        throw std::length_error("FrozenHashMap supports fewer than 2^31 keys.");
+    }
+    seeds.assign(std::max<size_t>(1, (n + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET), 0);
+
+    std::vector<uint64_t> hashes(n);
+    for (size_t i = 0; i < n; ++i) {
+        hashes[i] = hash(entries[i].first);
+    }
+
+    // Group entry indices by bucket with a counting sort.
+    std::vector<size_t> bucketStart(seeds.size() + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        bucketStart[bucketOf(hashes[i]) + 1]++;
+    }
+    for (size_t b = 0; b < seeds.size(); ++b) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+    std::vector<size_t> members(n);
+    std::vector<size_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        members[fill[bucketOf(hashes[i])]++] = i;
+    }
+
+    // Place the largest buckets first, while the table is still mostly free.
+    std::vector<size_t> order(seeds.size());
+    for (size_t b = 0; b < order.size(); ++b) {
+        order[b] = b;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+    });
+
+    // slotEntry[slot] is the entry placed there, or n while the slot is free.
+    std::vector<size_t> slotEntry(n, n);
+    std::vector<uint8_t> taken(n, 0);
+    std::vector<size_t> trial;
+    size_t nextFree = 0;
+    for (size_t b : order) {
+        size_t begin = bucketStart[b];
+        size_t count = bucketStart[b + 1] - begin;
+        if (count == 0) {
+            break;
+        }
+
+        if (count == 1) {
+            // Singletons take the remaining free slots directly.
+            while (taken[nextFree]) {
+                nextFree++;
+            }
+            slotEntry[nextFree] = members[begin];
+            taken[nextFree] = 1;
+            seeds[b] = DIRECT_SLOT | static_cast<uint32_t>(nextFree);
+            continue;
+        }
+
+        for (size_t i = begin; i < bucketStart[b + 1]; ++i) {
+            for (size_t j = begin; j < i; ++j) {
+                if (hashes[members[i]] == hashes[members[j]]) {
+                    throw std::runtime_error("FrozenHashMap cannot separate keys with identical hash codes.");
+                }
+            }
+        }
+
+        for (uint32_t seed = 0;; ++seed) {
+            if (seed == DIRECT_SLOT) {
+                throw std::runtime_error("FrozenHashMap could not place a bucket.");
+            }
+            trial.clear();
+            for (size_t i = begin; i < bucketStart[b + 1]; ++i) {
+                size_t slot = slotOf(hashes[members[i]], seed, n);
+                if (taken[slot] || std::find(trial.begin(), trial.end(), slot) != trial.end()) {
+                    break;
+                }
+                trial.push_back(slot);
+            }
+            if (trial.size() == count) {
+                for (size_t i = 0; i < count; ++i) {
+                    slotEntry[trial[i]] = members[begin + i];
+                    taken[trial[i]] = 1;
+                }
+                seeds[b] = seed;
+                break;
+            }
+        }
+    }
+
+    slots.reserve(n);
+    for (size_t slot = 0; slot < n; ++slot) {
+        size_t entry = slotEntry[slot];
+        slots.push_back(Slot{static_cast<uint16_t>(hashes[entry]), std::move(entries[entry].first),
+                             std::move(entries[entry].second)});
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename Q>
+const V* FrozenHashMap<K, V, Hash, KeyEqual>::lookup(const Q& key) const {
+    size_t slot = candidateSlot(hash(key));
+    if (slot == slots.size() || !hashmap_detail::keysEqual(keyEqual, slots[slot].key, key)) {
+        return nullptr;
+    }
+    return &slots[slot].value;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+const V* FrozenHashMap<K, V, Hash, KeyEqual>::find(const K& key) const {
+    return lookup(key);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename Q, typename>
+const V* FrozenHashMap<K, V, Hash, KeyEqual>::find(const Q& key) const {
+    return lookup(key);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool FrozenHashMap<K, V, Hash, KeyEqual>::search(const K& key, V& valueOut) const {
+    const V* value = lookup(key);
+    if (value == nullptr) {
+        return false;
+    }
+    valueOut = *value;
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename Q, typename>
+bool FrozenHashMap<K, V, Hash, KeyEqual>::search(const Q& key, V& valueOut) const {
+    const V* value = lookup(key);
+    if (value == nullptr) {
+        return false;
+    }
+    valueOut = *value;
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool FrozenHashMap<K, V, Hash, KeyEqual>::mayContain(const K& key) const {
+    return candidateSlot(hash(key)) != slots.size();
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename Q, typename>
+bool FrozenHashMap<K, V, Hash, KeyEqual>::mayContain(const Q& key) const {
+    return candidateSlot(hash(key)) != slots.size();
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+size_t FrozenHashMap<K, V, Hash, KeyEqual>::size() const {
+    return slots.size();
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void FrozenHashMap<K, V, Hash, KeyEqual>::printStats() const {
+    size_t directBuckets = 0;
+    size_t emptyBuckets = 0;
+    uint32_t largestSeed = 0;
+    std::vector<bool> used(seeds.size(), false);
+    for (const Slot& slot : slots) {
+        used[bucketOf(hash(slot.key))] = true;
+    }
+    for (size_t b = 0; b < seeds.size(); ++b) {
+        if (!used[b]) {
+            emptyBuckets++;
+        } else if ((seeds[b] & DIRECT_SLOT) != 0) {
+            directBuckets++;
+        } else {
+            largestSeed = std::max(largestSeed, seeds[b]);
+        }
+    }
+
+    std::cout << "FrozenHashMap Statistics:" << std::endl;
+    std::cout << "  Number of Elements: " << slots.size() << std::endl;
+    std::cout << "  Number of Buckets: " << seeds.size() << std::endl;
+    std::cout << "  Empty Buckets: " << emptyBuckets << std::endl;
+    std::cout << "  Single-Key Buckets: " << directBuckets << std::endl;
+    std::cout << "  Largest Displacement Seed: " << largestSeed << std::endl;
+    if (!slots.empty()) {
+        std::cout << "  Seed Bytes per Element: " << static_cast<double>(seeds.size() * sizeof(uint32_t)) / slots.size()
+                  << std::endl;
+    }
+}
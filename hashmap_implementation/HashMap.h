@@ -2,43 +2,360 @@
 #define HASHMAP_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <list>
+#include <memory>
 #include <utility>
 #include <functional>
+#include <iterator>
 #include <stdexcept> 
+#include <tuple>
+#include <type_traits>
+#include "SizePolicy.h"
+#include "NodePool.h"
+#include "HashMapMetrics.h"
+#include "BloomFilter.h"
 
-template <typename K, typename V>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <xmmintrin.h>
+#endif
+
+// Bucket layout policies. SeparateChaining keeps a std::list per bucket;
+// OpenAddressing stores entries in one flat array (see FlatHashMap.h).
+struct SeparateChaining {};
+struct OpenAddressing {};
+
+// Lookup types that hash and compare exactly like K, so search() can take them
+// without building a K first. std::hash<std::string_view> is required to agree
+// with std::hash<std::string>.
+template <typename K, typename Q>
+struct is_transparent_key : std::false_type {};
+
+template <>
+struct is_transparent_key<std::string, std::string_view> : std::true_type {};
+
+template <typename T, typename = void>
+struct has_is_transparent : std::false_type {};
+
+template <typename T>
+struct has_is_transparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+// Whether a map hashing with Hash and comparing with KeyEqual can look up a Q
+// directly. The std defaults qualify by way of std::hash<Q>; custom functors
+// have to declare is_transparent.
+template <typename K, typename Q, typename Hash, typename KeyEqual>
+struct supports_lookup_by
+    : std::integral_constant<bool,
+          is_transparent_key<K, Q>::value &&
+          (std::is_same<Hash, std::hash<K>>::value || has_is_transparent<Hash>::value) &&
+          (std::is_same<KeyEqual, std::equal_to<K>>::value || has_is_transparent<KeyEqual>::value)> {};
+
+namespace hashmap_detail {
+
+inline void prefetchForRead(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 3);
+#elif defined(_MSC_VER)
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#endif
+}
+
+template <typename K, typename Hash, typename Q>
+size_t hashOf(const Hash& hasher, const Q& key) {
+    if constexpr (std::is_same<Hash, std::hash<K>>::value) {
+        return std::hash<Q>{}(key);
+    } else {
+        return hasher(key);
+    }
+}
+
+template <typename K, typename KeyEqual, typename Q>
+bool keysEqual(const KeyEqual& keyEqual, const K& stored, const Q& key) {
+    if constexpr (std::is_same<KeyEqual, std::equal_to<K>>::value) {
+        return stored == key;
+    } else {
+        return keyEqual(stored, key);
+    }
+}
+
+// Default element conversion for the range constructors: the elements are
+// already (key, value) pairs.
+struct Identity {
+    template <typename T>
+    T&& operator()(T&& value) const {
+        return std::forward<T>(value);
+    }
+};
+
+// Body of the range constructors: size the table once from the range length
+// when it can be known up front, then place every entry without regrowing.
+// Later duplicates overwrite earlier ones, as with insert().
+template <typename Map, typename InputIt, typename Extract>
+void bulkInsert(Map& map, InputIt first, InputIt last, Extract& extract) {
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value) {
+        map.reserve(static_cast<size_t>(std::distance(first, last)));
+    }
+    for (; first != last; ++first) {
+        auto&& entry = extract(*first);
+        map.insert_or_assign(std::forward<decltype(entry)>(entry).first, std::forward<decltype(entry)>(entry).second);
+    }
+}
+
+// Keys resolved together by searchBatch(): enough independent misses in
+// flight to cover memory latency, small enough to keep on the stack.
+constexpr size_t BATCH_GROUP_SIZE = 16;
+
+// Empty buckets an incremental resize constructs at a time in the next table.
+constexpr size_t BUCKET_BUILD_RUN = 1024;
+
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+class FrozenHashMap;
+
+class MappedHashMap;
+
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+          typename Layout = SeparateChaining, typename SizePolicy = PrimeSizing,
+          typename Allocator = std::allocator<std::pair<K, V>>, typename Metrics = NoMetrics>
 class HashMap {
+    static_assert(std::is_same<Layout, SeparateChaining>::value,
+                  "HashMap layout must be SeparateChaining or OpenAddressing");
+
 private:
     static constexpr double LOAD_FACTOR_THRESHOLD = 0.75;
+
+    // Each node caches its key's full hash code: a rehash relinks nodes
+    // without hashing a key again, and a chain scan skips any node whose code
+    // differs before comparing keys.
+    struct Entry {
+        size_t hashValue;
+        std::pair<K, V> pair;
+
+        template <typename... Args>
+        explicit Entry(size_t hashValue, Args&&... args) : hashValue(hashValue), pair(std::forward<Args>(args)...) {}
+    };
+
+    // Every bucket is built from the map's own allocator, so nodes can be
+    // spliced between buckets even when the allocator is stateful.
+    using EntryAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Entry>;
+    using Bucket = std::list<Entry, EntryAllocator>;
     
-    std::vector<std::list<std::pair<K, V>>> table;
+    std::vector<Bucket> table;
+    SizePolicy sizing;
+    Hash hasher;
+    KeyEqual keyEqual;
+    Allocator allocator;
+    Metrics metrics;
+
+    // Incremental rehash: oldTable holds the buckets of the previous table
+    // that have not been moved into table yet. They are taken from its end,
+    // so an old index at or past oldTable.size() has already been migrated.
+    // Lookups consult both tables. Meanwhile nextTable is built up to
+    // nextCapacity empty buckets, ready to become table at the next resize.
+    std::vector<Bucket> oldTable;
+    SizePolicy oldSizing;
+    std::vector<Bucket> nextTable;
+    size_t nextCapacity;
+    size_t rehashStep;
     
     size_t numElements;
 
-    size_t hash(const K& key) const;
+    // Optional filter over the keys' hash codes; disabled unless
+    // setBloomFilter() was called.
+    BlockedBloomFilter filter;
+
+    // In incremental mode the filter's replacement is built alongside it
+    // rather than in one pass by the insert that fills it. A few units of work
+    // per insert first clear nextFilter's blocks, then scan the existing
+    // entries into it, table's buckets and then oldTable's, so that it is
+    // complete by the time filter is full. Once the scan has started,
+    // nextFilter also takes every new hash code. Buckets before
+    // filterScanIndex in the phase's table are done; migrateBuckets() adds
+    // entries that would otherwise move past the scan. Disabled when not in
+    // use.
+    enum class FilterScan { BUILD, TABLE, OLD_TABLE, DONE };
+    BlockedBloomFilter nextFilter;
+    FilterScan filterScan;
+    size_t filterScanIndex;
+
+    template <typename Q>
+    size_t hash(const Q& key) const;
+
+    // True when the filter proves no key has this hash code.
+    bool filterRejects(size_t hashValue) const;
+
+    // Adds a new entry's hash code to the filter, rebuilding it first if it
+    // is already holding as many keys as it was sized for.
+    void addToFilter(size_t hashValue);
+
+    // Refills the filter from the live entries, dropping removed keys, and
+    // in incremental mode starts building its replacement.
+    void rebuildFilter();
+
+    // Plans nextFilter for twice the entries there will be once filter is
+    // full.
+    void startFilterRebuild();
+
+    // This insert's share of clearing nextFilter and scanning buckets into it.
+    void advanceFilterRebuild();
+
+    // Whether nextFilter still lacks an entry migrating from old bucket
+    // oldIndex to bucket newIndex of table.
+    bool filterScanMisses(size_t oldIndex, size_t newIndex) const;
+
+    template <typename Q>
+    bool matches(const Entry& entry, const Q& key, size_t hashValue) const;
+
+    // Walks the chain for key, adding the number of entries visited to probes.
+    template <typename Q>
+    const std::pair<K, V>* lookup(const Q& key, size_t hashValue, size_t& probes) const;
+
+    // lookup() on behalf of a caller's find/search, reported to metrics.
+    template <typename Q>
+    const std::pair<K, V>* recordedLookup(const Q& key) const;
+
+    // Existing value for key, for the insert paths; not counted as a lookup.
+    V* findForUpdate(const K& key, size_t hashValue);
     
-    void resizeAndRehash();
+    // Empty buckets that all share allocator. Built one by one rather than
+    // copied from a prototype so move-only values still work.
+    std::vector<Bucket> makeTable(size_t capacity) const;
+    
+    // Moves every node into a fresh table of newCapacity buckets in one pass.
+    void rehash(size_t newCapacity);
     
-    size_t getNextPrime(size_t currentCapacity) const;
+    void resizeAndRehash();
+
+    void migrateBuckets(size_t count);
+
+    // Appends up to count empty buckets to nextTable, stopping at nextCapacity.
+    void buildBuckets(size_t count);
+
+    // Reserves nextTable for the capacity after table's. The memory is not
+    // touched until buildBuckets() constructs the buckets in it.
+    void planNextTable();
+
+    // Incremental mode's share of work for one insert or remove: enough
+    // migration and next-table buckets that both are done before the load
+    // factor forces the next resize, and at least rehashStep migrations.
+    void advanceRehash();
+
+    // Migration step and load-factor check that precede every insertion.
+    void prepareInsert();
+
+    template <typename KeyArg, typename... Args>
+    std::pair<V*, bool> emplaceNew(size_t hashValue, KeyArg&& key, Args&&... args);
 
 public:
-    HashMap(size_t initialCapacity = 101);
+    HashMap(size_t initialCapacity = 101, const Hash& hasher = Hash(), const KeyEqual& keyEqual = KeyEqual(),
+            const Allocator& allocator = Allocator());
+
+    // Bulk build from a range. Each element is passed through extract, which
+    // must yield something with .first (the key) and .second (the value); the
+    // default takes the elements as pairs already.
+    template <typename InputIt, typename Extract = hashmap_detail::Identity,
+              typename = typename std::iterator_traits<InputIt>::iterator_category>
+    HashMap(InputIt first, InputIt last, Extract extract = Extract(), const Hash& hasher = Hash(),
+            const KeyEqual& keyEqual = KeyEqual(), const Allocator& allocator = Allocator());
+
+    // Grow the table once so that count entries fit without another resize.
+    void reserve(size_t count);
+
+    // Spread each resize over later operations, moving at least
+    // bucketsPerOperation old buckets per insert/remove, and more when needed
+    // to finish before the next resize. 0 (the default) rehashes in one pass.
+    void setIncrementalRehash(size_t bucketsPerOperation);
+
+    // Put a blocked Bloom filter in front of lookups so that most absent keys
+    // are answered from one cache line without touching a chain. bitsPerKey
+    // trades memory for accuracy (10 gives about 1% false positives); 0 (the
+    // default) removes the filter. With incremental rehash on, the filter's
+    // periodic rebuild is spread over inserts too, at the cost of keeping a
+    // second filter.
+    void setBloomFilter(size_t bitsPerKey);
     
     void insert(const K& key, const V& value);
 
+    // The following return a pointer to the stored value and whether a new
+    // entry was created. emplace builds the node once and splices it in.
+    template <typename... Args>
+    std::pair<V*, bool> emplace(Args&&... args);
+
+    template <typename... Args>
+    std::pair<V*, bool> try_emplace(const K& key, Args&&... args);
+
+    template <typename... Args>
+    std::pair<V*, bool> try_emplace(K&& key, Args&&... args);
+
+    template <typename M>
+    std::pair<V*, bool> insert_or_assign(const K& key, M&& value);
+
+    template <typename M>
+    std::pair<V*, bool> insert_or_assign(K&& key, M&& value);
+
     bool search(const K& key, V& valueOut) const;
 
+    // Pointer to the stored value, or nullptr. Unlike search() nothing is copied.
+    V* find(const K& key);
+
+    const V* find(const K& key) const;
+
+    template <typename Q, typename = typename std::enable_if<supports_lookup_by<K, Q, Hash, KeyEqual>::value>::type>
+    const V* find(const Q& key) const;
+
+    template <typename Q, typename = typename std::enable_if<supports_lookup_by<K, Q, Hash, KeyEqual>::value>::type>
+    bool search(const Q& key, V& valueOut) const;
+
+    bool search(const char* key, size_t length, V& valueOut) const;
+
+    // Looks up count keys, storing a pointer to each stored value (or nullptr)
+    // in out, and returns the number found. Buckets for a whole group of keys
+    // are prefetched before any chain is walked.
+    size_t searchBatch(const K* keys, size_t count, const V** out) const;
+
     bool remove(const K& key);
+
+    // Read-only copy of the current contents with one probe per lookup; see
+    // FrozenHashMap.h. The map itself stays usable for further updates.
+    FrozenHashMap<K, V, Hash, KeyEqual> freeze() const;
+
+    // Write the contents as a memory-mappable snapshot. Defined in
+    // MappedHashMap.h, which callers include to use either of these. Keys and
+    // values must be viewable as std::string_view.
+    void save(const std::string& path) const;
+
+    // Open a snapshot written by save() without loading it.
+    static MappedHashMap mapFile(const std::string& path);
+
+    // Operation counters, probe-length histogram and rehash time. Only the
+    // size fields are filled unless Metrics is CountingMetrics.
+    HashMapStats stats() const;
     
     size_t size() const;
     
+    // Destroys every entry. With a NodePoolAllocator the pool's slabs are
+    // then released in one go rather than node by node.
     void clear();
     
     void printStats() const;
 };
 
+// Chained HashMap whose nodes come from a NodePool: slab allocation instead of
+// one heap call per insert, and removed nodes are recycled.
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+          typename SizePolicy = PrimeSizing>
+using PooledHashMap = HashMap<K, V, Hash, KeyEqual, SeparateChaining, SizePolicy, NodePoolAllocator<std::pair<K, V>>>;
+
+// HashMap that keeps the counters reported by stats().
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+          typename Layout = SeparateChaining>
+using InstrumentedHashMap = HashMap<K, V, Hash, KeyEqual, Layout, PrimeSizing, std::allocator<std::pair<K, V>>, CountingMetrics>;
+
 #include "HashMap.tpp"
+#include "FlatHashMap.h"
+#include "FrozenHashMap.h"
 
 #endif
\ No newline at end of file
@@ -4,116 +4,657 @@
 #include <algorithm>
 #include "HashMap.h" 
 
-template <typename K, typename V>
-size_t HashMap<K, V>::getNextPrime(size_t currentCapacity) const {
-    size_t newCapacity = currentCapacity * 2 + 1;
-    while (true) {
-        bool isPrime = true;
-        for (size_t i = 2; i * i <= newCapacity; ++i) {
-            if (newCapacity % i == 0) {
-                isPrime = false;
-                break;
-            }
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename Q>
+size_t HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::hash(const Q& key) const {
+    return hashmap_detail::hashOf<K>(hasher, key);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename Q>
+bool HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::matches(const Entry& entry, const Q& key, size_t hashValue) const {
+    return entry.hashValue == hashValue && hashmap_detail::keysEqual(keyEqual, entry.pair.first, key);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+bool HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::filterRejects(size_t hashValue) const {
+    return filter.enabled() && !filter.mayContain(hashValue);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::addToFilter(size_t hashValue) {
+    if (!filter.enabled()) {
+        return;
+    }
+    if (nextFilter.enabled()) {
+        // The scan finishes by the insert that finds filter full, so the
+        // replacement is ready to take over then.
+        advanceFilterRebuild();
+        if (filter.full()) {
+            filter.replaceWith(std::move(nextFilter));
+            startFilterRebuild();
+        }
+        // Until the scan starts, it will find this entry in table.
+        if (filterScan != FilterScan::BUILD) {
+            nextFilter.insert(hashValue);
+        }
+    } else if (filter.full()) {
+        rebuildFilter();
+    }
+    filter.insert(hashValue);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::rebuildFilter() {
+    // Sized for twice the current count, so rebuilds stay amortized O(1).
+    filter.reset(std::max<size_t>(numElements * 2, 64));
+    for (const auto& bucket : table) {
+        for (const auto& entry : bucket) {
+            filter.insert(entry.hashValue);
+        }
+    }
+    for (const auto& bucket : oldTable) {
+        for (const auto& entry : bucket) {
+            filter.insert(entry.hashValue);
+        }
+    }
+    nextFilter = BlockedBloomFilter();
+    if (rehashStep > 0) {
+        startFilterRebuild();
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::startFilterRebuild() {
+    nextFilter = BlockedBloomFilter(filter.bitsPerKeySetting(), 0);
+    nextFilter.plan(std::max<size_t>((numElements + filter.room()) * 2, 64));
+    filterScan = FilterScan::BUILD;
+    filterScanIndex = 0;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::advanceFilterRebuild() {
+    size_t unbuilt = nextFilter.unbuiltBlocks();
+    size_t unscanned = 0;
+    if (filterScan == FilterScan::BUILD) {
+        unscanned = table.size() + oldTable.size();
+    } else if (filterScan == FilterScan::TABLE) {
+        unscanned = table.size() - filterScanIndex + oldTable.size();
+    } else if (filterScan == FilterScan::OLD_TABLE && filterScanIndex < oldTable.size()) {
+        unscanned = oldTable.size() - filterScanIndex;
+    }
+    // Counting this insert, filter takes room() more before it is full.
+    size_t inserts = std::max<size_t>(filter.room(), 1);
+    size_t count = (unbuilt + unscanned + inserts - 1) / inserts;
+
+    size_t building = std::min(count, unbuilt);
+    nextFilter.buildBlocks(building);
+    count -= building;
+    if (filterScan == FilterScan::BUILD && nextFilter.unbuiltBlocks() == 0) {
+        filterScan = FilterScan::TABLE;
+    }
+
+    while (count > 0 && filterScan == FilterScan::TABLE) {
+        if (filterScanIndex == table.size()) {
+            filterScan = FilterScan::OLD_TABLE;
+            filterScanIndex = 0;
+            break;
         }
-        if (isPrime) {
-            return newCapacity;
+        for (const auto& entry : table[filterScanIndex]) {
+            nextFilter.insert(entry.hashValue);
         }
-        newCapacity += 2;
+        filterScanIndex++;
+        count--;
+    }
+    while (count > 0 && filterScanIndex < oldTable.size()) {
+        for (const auto& entry : oldTable[filterScanIndex]) {
+            nextFilter.insert(entry.hashValue);
+        }
+        filterScanIndex++;
+        count--;
+    }
+    if (filterScan == FilterScan::OLD_TABLE && filterScanIndex >= oldTable.size()) {
+        filterScan = FilterScan::DONE;
     }
 }
 
-template <typename K, typename V>
-size_t HashMap<K, V>::hash(const K& key) const {
-    return std::hash<K>{}(key) % table.size();
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+bool HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::filterScanMisses(size_t oldIndex, size_t newIndex) const {
+    if (!nextFilter.enabled()) {
+        return false;
+    }
+    switch (filterScan) {
+        case FilterScan::TABLE:
+            // Lands behind the scan, and its old bucket is scanned too late.
+            return newIndex < filterScanIndex;
+        case FilterScan::OLD_TABLE:
+            // Leaves its old bucket before the scan reaches it.
+            return oldIndex >= filterScanIndex;
+        default:
+            return false;
+    }
 }
 
-template <typename K, typename V>
-HashMap<K, V>::HashMap(size_t initialCapacity) : numElements(0) {
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::HashMap(size_t initialCapacity, const Hash& hasher,
+                                                                       const KeyEqual& keyEqual, const Allocator& allocator)
+    : hasher(hasher), keyEqual(keyEqual), allocator(allocator), nextCapacity(0), rehashStep(0), numElements(0),
+      filterScan(FilterScan::DONE), filterScanIndex(0) {
     if (initialCapacity < 1) {
         throw std::invalid_argument("Capacity must be positive.");
     }
-    size_t primeCapacity = getNextPrime(initialCapacity);
-    table.resize(primeCapacity); 
+    size_t capacity = SizePolicy::nextCapacity(initialCapacity);
+    table = makeTable(capacity);
+    sizing = SizePolicy(capacity);
 }
 
-template <typename K, typename V>
-void HashMap<K, V>::resizeAndRehash() {
-    size_t oldCapacity = table.size();
-    size_t newCapacity = getNextPrime(oldCapacity);
-    
-    std::vector<std::list<std::pair<K, V>>> newTable(newCapacity);
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename InputIt, typename Extract, typename>
+HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::HashMap(InputIt first, InputIt last, Extract extract, const Hash& hasher,
+                                                                       const KeyEqual& keyEqual, const Allocator& allocator)
+    : HashMap(1, hasher, keyEqual, allocator) {
+    hashmap_detail::bulkInsert(*this, first, last, extract);
+}
 
-    for (const auto& bucket : table) {
-        for (const auto& pair : bucket) {
-            size_t newIndex = std::hash<K>{}(pair.first) % newCapacity;
-            newTable[newIndex].push_back(pair);
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::reserve(size_t count) {
+    size_t newCapacity = table.size();
+    while (static_cast<double>(count) / newCapacity > LOAD_FACTOR_THRESHOLD) {
+        newCapacity = SizePolicy::nextCapacity(newCapacity);
+    }
+    if (newCapacity != table.size()) {
+        auto timer = metrics.startTimer();
+        migrateBuckets(oldTable.size());
+        rehash(newCapacity);
+        if (rehashStep > 0) {
+            planNextTable();
+        }
+        // The one-pass rehash moved every entry past the filter scan.
+        if (nextFilter.enabled()) {
+            rebuildFilter();
+        }
+        metrics.recordRehash(timer);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::setIncrementalRehash(size_t bucketsPerOperation) {
+    if (bucketsPerOperation == 0) {
+        migrateBuckets(oldTable.size());
+        std::vector<Bucket>().swap(nextTable);
+        nextCapacity = 0;
+        nextFilter = BlockedBloomFilter();
+    } else if (rehashStep == 0) {
+        planNextTable();
+        if (filter.enabled()) {
+            startFilterRebuild();
+        }
+    }
+    rehashStep = bucketsPerOperation;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::setBloomFilter(size_t bitsPerKey) {
+    filter = BlockedBloomFilter(bitsPerKey, 0);
+    nextFilter = BlockedBloomFilter();
+    if (filter.enabled()) {
+        rebuildFilter();
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::migrateBuckets(size_t count) {
+    // Popping each drained bucket spreads the old table's destruction over
+    // the same operations as its migration.
+    while (count > 0 && !oldTable.empty()) {
+        auto& bucket = oldTable.back();
+        while (!bucket.empty()) {
+            size_t index = sizing.index(bucket.front().hashValue);
+            if (filterScanMisses(oldTable.size() - 1, index)) {
+                nextFilter.insert(bucket.front().hashValue);
+            }
+            table[index].splice(table[index].end(), bucket, bucket.begin());
+        }
+        oldTable.pop_back();
+        count--;
+    }
+
+    if (oldTable.empty()) {
+        std::vector<Bucket>().swap(oldTable);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::buildBuckets(size_t count) {
+    while (count > 0 && nextTable.size() < nextCapacity) {
+        nextTable.emplace_back(allocator);
+        count--;
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::planNextTable() {
+    std::vector<Bucket>().swap(nextTable);
+    try {
+        nextCapacity = SizePolicy::nextCapacity(table.size());
+    } catch (const std::length_error&) {
+        // No room to grow; resizeAndRehash() reports it if it is ever needed.
+        nextCapacity = 0;
+        return;
+    }
+    nextTable.reserve(nextCapacity);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::advanceRehash() {
+    // Growth happens in the prepareInsert() that finds more than limit
+    // entries, so counting this one there are limit - numElements + 1 calls
+    // left to do the remaining work in.
+    size_t limit = static_cast<size_t>(LOAD_FACTOR_THRESHOLD * table.size());
+    size_t remaining = numElements <= limit ? limit - numElements + 1 : 1;
+    if (!oldTable.empty()) {
+        migrateBuckets(std::max(rehashStep, (oldTable.size() + remaining - 1) / remaining));
+    }
+    // Buckets are built in runs, which stream through memory far faster than
+    // one bucket per call scattered between other work, and a run is only
+    // started once the calls left could not finish the table otherwise.
+    size_t unbuilt = nextCapacity - nextTable.size();
+    if (unbuilt > (remaining - 1) * hashmap_detail::BUCKET_BUILD_RUN) {
+        buildBuckets(std::max(hashmap_detail::BUCKET_BUILD_RUN, (unbuilt + remaining - 1) / remaining));
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+std::vector<typename HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::Bucket>
+HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::makeTable(size_t capacity) const {
+    std::vector<Bucket> buckets;
+    buckets.reserve(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        buckets.emplace_back(allocator);
+    }
+    return buckets;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::rehash(size_t newCapacity) {
+    SizePolicy newSizing(newCapacity);
+    std::vector<Bucket> newTable = makeTable(newCapacity);
+
+    // Relink the existing nodes instead of copying their pairs; each node's
+    // cached hash code picks its new bucket.
+    for (auto& bucket : table) {
+        while (!bucket.empty()) {
+            auto& target = newTable[newSizing.index(bucket.front().hashValue)];
+            target.splice(target.end(), bucket, bucket.begin());
         }
     }
 
     table = std::move(newTable);
+    sizing = newSizing;
 }
 
-template <typename K, typename V>
-void HashMap<K, V>::insert(const K& key, const V& value) {
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::resizeAndRehash() {
+    size_t newCapacity = SizePolicy::nextCapacity(table.size());
+    auto timer = metrics.startTimer();
+
+    if (rehashStep > 0) {
+        // advanceRehash() has normally finished both already; this only
+        // catches up after a copy or a change of step.
+        migrateBuckets(oldTable.size());
+        nextCapacity = newCapacity;
+        buildBuckets(newCapacity);
+        oldTable = std::move(table);
+        oldSizing = sizing;
+        table = std::move(nextTable);
+        sizing = SizePolicy(newCapacity);
+        planNextTable();
+        // The scanned table became oldTable with its buckets in place, and the
+        // new table holds nothing yet; a scan of oldTable has just been
+        // migrated in full. A scan yet to start covers both tables anyway.
+        if (filterScan == FilterScan::TABLE) {
+            filterScan = FilterScan::OLD_TABLE;
+        } else if (filterScan == FilterScan::OLD_TABLE) {
+            filterScan = FilterScan::DONE;
+        }
+    } else {
+        rehash(newCapacity);
+    }
+    metrics.recordRehash(timer);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::prepareInsert() {
+    if (rehashStep > 0) {
+        advanceRehash();
+    }
+
     if (static_cast<double>(numElements) / table.size() > LOAD_FACTOR_THRESHOLD) {
         resizeAndRehash();
     }
+}
 
-    size_t index = hash(key);
-    
-    for (auto& pair : table[index]) {
-        if (pair.first == key) {
-            pair.second = value;
-            return;
-        }
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename KeyArg, typename... Args>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::emplaceNew(size_t hashValue, KeyArg&& key, Args&&... args) {
+    addToFilter(hashValue);
+    auto& bucket = table[sizing.index(hashValue)];
+    bucket.emplace_back(hashValue, std::piecewise_construct,
+                        std::forward_as_tuple(std::forward<KeyArg>(key)),
+                        std::forward_as_tuple(std::forward<Args>(args)...));
+    numElements++;
+    metrics.recordInsert();
+    return {&bucket.back().pair.second, true};
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::insert(const K& key, const V& value) {
+    insert_or_assign(key, value);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename... Args>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::emplace(Args&&... args) {
+    prepareInsert();
+
+    Bucket node(allocator);
+    node.emplace_back(0, std::forward<Args>(args)...);
+    Entry& entry = node.front();
+    entry.hashValue = hash(entry.pair.first);
+
+    if (V* existing = findForUpdate(entry.pair.first, entry.hashValue)) {
+        return {existing, false};
     }
-    
-    table[index].emplace_back(key, value);
+
+    addToFilter(entry.hashValue);
+    auto& bucket = table[sizing.index(entry.hashValue)];
+    bucket.splice(bucket.end(), node);
     numElements++;
+    metrics.recordInsert();
+    return {&bucket.back().pair.second, true};
 }
 
-template <typename K, typename V>
-bool HashMap<K, V>::search(const K& key, V& valueOut) const {
-    size_t index = hash(key); 
-    
-    for (const auto& pair : table[index]) {
-        if (pair.first == key) {
-            valueOut = pair.second; 
-            return true;
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename... Args>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::try_emplace(const K& key, Args&&... args) {
+    size_t hashValue = hash(key);
+    prepareInsert();
+    if (V* existing = findForUpdate(key, hashValue)) {
+        return {existing, false};
+    }
+    return emplaceNew(hashValue, key, std::forward<Args>(args)...);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename... Args>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::try_emplace(K&& key, Args&&... args) {
+    size_t hashValue = hash(key);
+    prepareInsert();
+    if (V* existing = findForUpdate(key, hashValue)) {
+        return {existing, false};
+    }
+    return emplaceNew(hashValue, std::move(key), std::forward<Args>(args)...);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename M>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::insert_or_assign(const K& key, M&& value) {
+    size_t hashValue = hash(key);
+    prepareInsert();
+    if (V* existing = findForUpdate(key, hashValue)) {
+        *existing = std::forward<M>(value);
+        metrics.recordUpdate();
+        return {existing, false};
+    }
+    return emplaceNew(hashValue, key, std::forward<M>(value));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename M>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::insert_or_assign(K&& key, M&& value) {
+    size_t hashValue = hash(key);
+    prepareInsert();
+    if (V* existing = findForUpdate(key, hashValue)) {
+        *existing = std::forward<M>(value);
+        metrics.recordUpdate();
+        return {existing, false};
+    }
+    return emplaceNew(hashValue, std::move(key), std::forward<M>(value));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename Q>
+const std::pair<K, V>* HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::lookup(const Q& key, size_t hashValue, size_t& probes) const {
+    for (const auto& entry : table[sizing.index(hashValue)]) {
+        probes++;
+        if (matches(entry, key, hashValue)) {
+            return &entry.pair;
+        }
+    }
+
+    if (!oldTable.empty()) {
+        size_t oldIndex = oldSizing.index(hashValue);
+        if (oldIndex < oldTable.size()) {
+            for (const auto& entry : oldTable[oldIndex]) {
+                probes++;
+                if (matches(entry, key, hashValue)) {
+                    return &entry.pair;
+                }
+            }
         }
     }
-    return false; 
+    return nullptr; 
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename Q>
+const std::pair<K, V>* HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::recordedLookup(const Q& key) const {
+    size_t hashValue = hash(key);
+    if (filterRejects(hashValue)) {
+        filter.recordRejection();
+        metrics.recordLookup(false, 0);
+        return nullptr;
+    }
+    size_t probes = 0;
+    const std::pair<K, V>* pair = lookup(key, hashValue, probes);
+    metrics.recordLookup(pair != nullptr, probes);
+    return pair;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+V* HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::findForUpdate(const K& key, size_t hashValue) {
+    if (filterRejects(hashValue)) {
+        return nullptr;
+    }
+    size_t probes = 0;
+    const std::pair<K, V>* pair = lookup(key, hashValue, probes);
+    return pair != nullptr ? const_cast<V*>(&pair->second) : nullptr;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+bool HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::search(const K& key, V& valueOut) const {
+    const std::pair<K, V>* pair = recordedLookup(key);
+    if (pair == nullptr) {
+        return false;
+    }
+    valueOut = pair->second;
+    return true;
 }
 
-template <typename K, typename V>
-bool HashMap<K, V>::remove(const K& key) {
-    size_t index = hash(key); 
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename Q, typename>
+bool HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::search(const Q& key, V& valueOut) const {
+    const std::pair<K, V>* pair = recordedLookup(key);
+    if (pair == nullptr) {
+        return false;
+    }
+    valueOut = pair->second;
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+V* HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::find(const K& key) {
+    const std::pair<K, V>* pair = recordedLookup(key);
+    return pair != nullptr ? const_cast<V*>(&pair->second) : nullptr;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+const V* HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::find(const K& key) const {
+    const std::pair<K, V>* pair = recordedLookup(key);
+    return pair != nullptr ? &pair->second : nullptr;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+template <typename Q, typename>
+const V* HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::find(const Q& key) const {
+    const std::pair<K, V>* pair = recordedLookup(key);
+    return pair != nullptr ? &pair->second : nullptr;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+bool HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::search(const char* key, size_t length, V& valueOut) const {
+    return search(std::string_view(key, length), valueOut);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+size_t HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::searchBatch(const K* keys, size_t count, const V** out) const {
+    size_t hashValues[hashmap_detail::BATCH_GROUP_SIZE];
+    size_t indices[hashmap_detail::BATCH_GROUP_SIZE];
+    bool rejected[hashmap_detail::BATCH_GROUP_SIZE];
+    size_t found = 0;
+
+    for (size_t base = 0; base < count; base += hashmap_detail::BATCH_GROUP_SIZE) {
+        size_t groupSize = std::min(hashmap_detail::BATCH_GROUP_SIZE, count - base);
+
+        for (size_t i = 0; i < groupSize; ++i) {
+            hashValues[i] = hash(keys[base + i]);
+            indices[i] = sizing.index(hashValues[i]);
+            rejected[i] = filterRejects(hashValues[i]);
+            if (!rejected[i]) {
+                hashmap_detail::prefetchForRead(&table[indices[i]]);
+            }
+        }
+
+        for (size_t i = 0; i < groupSize; ++i) {
+            const auto& bucket = table[indices[i]];
+            if (!rejected[i] && !bucket.empty()) {
+                hashmap_detail::prefetchForRead(&bucket.front());
+            }
+        }
+
+        for (size_t i = 0; i < groupSize; ++i) {
+            if (rejected[i]) {
+                filter.recordRejection();
+                metrics.recordLookup(false, 0);
+                out[base + i] = nullptr;
+                continue;
+            }
+
+            const std::pair<K, V>* match = nullptr;
+            size_t probes = 0;
+            for (const auto& entry : table[indices[i]]) {
+                probes++;
+                if (matches(entry, keys[base + i], hashValues[i])) {
+                    match = &entry.pair;
+                    break;
+                }
+            }
+            if (match == nullptr && !oldTable.empty()) {
+                // Starts over in the new table, so reset the count.
+                probes = 0;
+                match = lookup(keys[base + i], hashValues[i], probes);
+            }
+            metrics.recordLookup(match != nullptr, probes);
+
+            out[base + i] = match != nullptr ? &match->second : nullptr;
+            if (match != nullptr) {
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+bool HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::remove(const K& key) {
+    if (rehashStep > 0) {
+        advanceRehash();
+    }
+
+    size_t hashValue = hash(key);
+    size_t index = sizing.index(hashValue);
     
     for (auto it = table[index].begin(); it != table[index].end(); ++it) {
-        if (it->first == key) {
+        if (matches(*it, key, hashValue)) {
             table[index].erase(it); 
             numElements--;
+            metrics.recordRemove();
             return true;
         }
     }
+
+    if (!oldTable.empty() && oldSizing.index(hashValue) < oldTable.size()) {
+        auto& bucket = oldTable[oldSizing.index(hashValue)];
+        for (auto it = bucket.begin(); it != bucket.end(); ++it) {
+            if (matches(*it, key, hashValue)) {
+                bucket.erase(it);
+                numElements--;
+                metrics.recordRemove();
+                return true;
+            }
+        }
+    }
     return false;
 }
 
-template <typename K, typename V>
-size_t HashMap<K, V>::size() const {
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+FrozenHashMap<K, V, Hash, KeyEqual> HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::freeze() const {
+    std::vector<std::pair<K, V>> entries;
+    entries.reserve(numElements);
+    for (const auto& bucket : table) {
+        for (const auto& entry : bucket) {
+            entries.push_back(entry.pair);
+        }
+    }
+    for (const auto& bucket : oldTable) {
+        for (const auto& entry : bucket) {
+            entries.push_back(entry.pair);
+        }
+    }
+    return FrozenHashMap<K, V, Hash, KeyEqual>(std::move(entries), hasher, keyEqual);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+HashMapStats HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::stats() const {
+    HashMapStats result;
+    metrics.fill(result);
+    result.filterRejects = filter.rejectedQueries();
+    result.size = numElements;
+    result.capacity = table.size();
+    result.loadFactor = table.empty() ? 0.0 : static_cast<double>(numElements) / table.size();
+    return result;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+size_t HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::size() const {
     return numElements;
 }
 
-template <typename K, typename V>
-void HashMap<K, V>::clear() {
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::clear() {
     for (auto& bucket : table) {
         bucket.clear();
     }
+    std::vector<Bucket>().swap(oldTable);
     numElements = 0;
+    hashmap_detail::releaseIfIdle(allocator);
+    if (filter.enabled()) {
+        rebuildFilter();
+    }
 }
 
-template <typename K, typename V>
-void HashMap<K, V>::printStats() const {
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::printStats() const {
     std::cout << "HashMap Statistics:" << std::endl;
     std::cout << "  Current Capacity: " << table.size() << std::endl;
     std::cout << "  Number of Elements: " << numElements << std::endl;
@@ -136,4 +677,17 @@ void HashMap<K, V>::printStats() const {
     std::cout << "  Average Chain Length: " << static_cast<double>(totalChainLength) / table.size() << std::endl;
     std::cout << "  Longest Chain Length: " << longestChain << std::endl;
     std::cout << "  Number of Empty Buckets: " << emptyBuckets << std::endl;
+
+    if (!oldTable.empty()) {
+        std::cout << "  Rehash In Progress: " << oldTable.size() << " old buckets left to migrate" << std::endl;
+    }
+
+    if (filter.enabled()) {
+        std::cout << "  Bloom Filter: " << filter.sizeInBytes() << " bytes, " << filter.rejectedQueries()
+                  << " lookups rejected" << std::endl;
+    }
+
+    if constexpr (Metrics::ENABLED) {
+        std::cout << "  Metrics: " << stats().toJson() << std::endl;
+    }
 }
@@ -0,0 +1,148 @@
+#ifndef HASHMAPMETRICS_H
+#define HASHMAPMETRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// Snapshot returned by HashMap::stats(). Counters stay zero unless the map
+// was instantiated with CountingMetrics.
+struct HashMapStats {
+    // probeHistogram[i] counts lookups that examined i entries (chained
+    // layout) or i control groups (open addressing); the last bucket also
+    // takes every longer probe.
+    static constexpr size_t PROBE_BUCKETS = 16;
+
+    size_t inserts = 0;
+    size_t updates = 0;
+    size_t removes = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t rehashes = 0;
+    uint64_t rehashNanoseconds = 0;
+    size_t probeHistogram[PROBE_BUCKETS] = {};
+
+    // Lookups answered by the Bloom filter alone. Counted whenever the filter
+    // is enabled, whatever the Metrics policy.
+    size_t filterRejects = 0;
+
+    size_t size = 0;
+    size_t capacity = 0;
+    double loadFactor = 0.0;
+
+    std::string toJson() const {
+        std::ostringstream out;
+        out << "{\"size\":" << size << ",\"capacity\":" << capacity << ",\"loadFactor\":" << loadFactor
+            << ",\"inserts\":" << inserts << ",\"updates\":" << updates << ",\"removes\":" << removes
+            << ",\"hits\":" << hits << ",\"misses\":" << misses << ",\"rehashes\":" << rehashes
+            << ",\"rehashNanoseconds\":" << rehashNanoseconds << ",\"filterRejects\":" << filterRejects
+            << ",\"probeHistogram\":[";
+        for (size_t i = 0; i < PROBE_BUCKETS; ++i) {
+            out << (i > 0 ? "," : "") << probeHistogram[i];
+        }
+        out << "]}";
+        return out.str();
+    }
+};
+
+// Metrics policies for HashMap's Metrics parameter. NoMetrics (the default)
+// is empty and every hook is an inline no-op, so an uninstrumented map
+// compiles to the same code as before.
+struct NoMetrics {
+    static constexpr bool ENABLED = false;
+
+    int startTimer() const { return 0; }
+    void recordInsert() {}
+    void recordUpdate() {}
+    void recordRemove() {}
+    void recordLookup(bool, size_t) const {}
+    void recordRehash(int) {}
+    void fill(HashMapStats&) const {}
+};
+
+// Counts every operation. Lookups are const and may run under a shared lock,
+// so counters are atomics bumped with a relaxed load and store rather than a
+// locked read-modify-write: concurrent readers can lose the odd increment but
+// never tear a counter, and a single thread pays for a plain increment.
+class CountingMetrics {
+public:
+    static constexpr bool ENABLED = true;
+
+    CountingMetrics() = default;
+
+    CountingMetrics(const CountingMetrics& other) {
+        copyFrom(other);
+    }
+
+    CountingMetrics& operator=(const CountingMetrics& other) {
+        copyFrom(other);
+        return *this;
+    }
+
+    std::chrono::steady_clock::time_point startTimer() const {
+        return std::chrono::steady_clock::now();
+    }
+
+    void recordInsert() { bump(inserts); }
+    void recordUpdate() { bump(updates); }
+    void recordRemove() { bump(removes); }
+
+    void recordLookup(bool hit, size_t probes) const {
+        bump(hit ? hits : misses);
+        bump(probeHistogram[probes < HashMapStats::PROBE_BUCKETS ? probes : HashMapStats::PROBE_BUCKETS - 1]);
+    }
+
+    void recordRehash(std::chrono::steady_clock::time_point start) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        bump(rehashes);
+        bump(rehashNanoseconds, static_cast<uint64_t>(elapsed.count()));
+    }
+
+    void fill(HashMapStats& stats) const {
+        stats.inserts = inserts.load(std::memory_order_relaxed);
+        stats.updates = updates.load(std::memory_order_relaxed);
+        stats.removes = removes.load(std::memory_order_relaxed);
+        stats.hits = hits.load(std::memory_order_relaxed);
+        stats.misses = misses.load(std::memory_order_relaxed);
+        stats.rehashes = rehashes.load(std::memory_order_relaxed);
+        stats.rehashNanoseconds = rehashNanoseconds.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < HashMapStats::PROBE_BUCKETS; ++i) {
+            stats.probeHistogram[i] = probeHistogram[i].load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::atomic<size_t> inserts{0};
+    std::atomic<size_t> updates{0};
+    std::atomic<size_t> removes{0};
+    mutable std::atomic<size_t> hits{0};
+    mutable std::atomic<size_t> misses{0};
+    std::atomic<size_t> rehashes{0};
+    std::atomic<uint64_t> rehashNanoseconds{0};
+    mutable std::atomic<size_t> probeHistogram[HashMapStats::PROBE_BUCKETS] = {};
+
+    template <typename T>
+    static void bump(std::atomic<T>& counter, T amount = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void copyFrom(const CountingMetrics& other) {
+        HashMapStats stats;
+        other.fill(stats);
+        inserts.store(stats.inserts, std::memory_order_relaxed);
+        updates.store(stats.updates, std::memory_order_relaxed);
+        removes.store(stats.removes, std::memory_order_relaxed);
+        hits.store(stats.hits, std::memory_order_relaxed);
+        misses.store(stats.misses, std::memory_order_relaxed);
+        rehashes.store(stats.rehashes, std::memory_order_relaxed);
+        rehashNanoseconds.store(stats.rehashNanoseconds, std::memory_order_relaxed);
+        for (size_t i = 0; i < HashMapStats::PROBE_BUCKETS; ++i) {
+            probeHistogram[i].store(stats.probeHistogram[i], std::memory_order_relaxed);
+        }
+    }
+};
+
+#endif
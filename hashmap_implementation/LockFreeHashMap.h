@@ -0,0 +1,84 @@
+#ifndef LOCKFREEHASHMAP_H
+#define LOCKFREEHASHMAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include "HashMap.h"
+#include "EpochReclaimer.h"
+
+// Read-mostly map whose search() is wait-free: readers never lock and never
+// write to shared memory. Writers are serialized by a mutex and publish every
+// change with a single atomic pointer store - a new node spliced into a chain,
+// or a whole new table on resize - and retire what they replaced through
+// EpochReclaimer so it is only freed once no reader can be looking at it.
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class LockFreeHashMap {
+private:
+    static constexpr double LOAD_FACTOR_THRESHOLD = 0.75;
+
+    // Published nodes are never modified except for their next link.
+    struct Node {
+        K key;
+        V value;
+        std::atomic<Node*> next;
+
+        Node(const K& key, const V& value, Node* next) : key(key), value(value), next(next) {}
+    };
+
+    struct Table {
+        size_t capacity;   // always a power of two
+        std::unique_ptr<std::atomic<Node*>[]> buckets;
+
+        explicit Table(size_t capacity);
+    };
+
+    std::atomic<Table*> table;
+    std::atomic<size_t> numElements;
+    Hash hasher;
+    KeyEqual keyEqual;
+
+    std::mutex writeMutex;
+    RetireList retired;
+
+    template <typename Q>
+    size_t hash(const Q& key, size_t capacity) const;
+
+    // Caller must hold an EpochGuard.
+    template <typename Q>
+    const Node* lookup(const Q& key) const;
+
+    // Caller must hold writeMutex.
+    void resizeAndRehash();
+
+    static void destroyTable(void* table);
+
+public:
+    LockFreeHashMap(size_t initialCapacity = 101, const Hash& hasher = Hash(), const KeyEqual& keyEqual = KeyEqual());
+
+    LockFreeHashMap(const LockFreeHashMap&) = delete;
+
+    LockFreeHashMap& operator=(const LockFreeHashMap&) = delete;
+
+    ~LockFreeHashMap();
+
+    void insert(const K& key, const V& value);
+
+    bool search(const K& key, V& valueOut) const;
+
+    template <typename Q, typename = typename std::enable_if<supports_lookup_by<K, Q, Hash, KeyEqual>::value>::type>
+    bool search(const Q& key, V& valueOut) const;
+
+    bool remove(const K& key);
+
+    size_t size() const;
+
+    void clear();
+
+    void printStats() const;
+};
+
+#include "LockFreeHashMap.tpp"
+
+#endif
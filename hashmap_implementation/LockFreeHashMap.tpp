@@ -0,0 +1,206 @@
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include "LockFreeHashMap.h"
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+LockFreeHashMap<K, V, Hash, KeyEqual>::Table::Table(size_t capacity)
+    : capacity(capacity), buckets(new std::atomic<Node*>[capacity]) {
+    for (size_t i = 0; i < capacity; ++i) {
+        buckets[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename Q>
+size_t LockFreeHashMap<K, V, Hash, KeyEqual>::hash(const Q& key, size_t capacity) const {
+    // Power-of-two tables keep the divide off the read path; mix first so the
+    // mask does not only see the low bits of std::hash.
+    uint64_t h = static_cast<uint64_t>(hashmap_detail::hashOf<K>(hasher, key)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(h ^ (h >> 32)) & (capacity - 1);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void LockFreeHashMap<K, V, Hash, KeyEqual>::destroyTable(void* ptr) {
+    Table* doomed = static_cast<Table*>(ptr);
+    for (size_t i = 0; i < doomed->capacity; ++i) {
+        Node* node = doomed->buckets[i].load(std::memory_order_relaxed);
+        while (node != nullptr) {
+            Node* next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+    delete doomed;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+LockFreeHashMap<K, V, Hash, KeyEqual>::LockFreeHashMap(size_t initialCapacity, const Hash& hasher, const KeyEqual& keyEqual)
+    : table(nullptr), numElements(0), hasher(hasher), keyEqual(keyEqual) {
+    if (initialCapacity < 1) {
+        throw std::invalid_argument("Capacity must be positive.");
+    }
+    size_t powerOfTwo = 1;
+    while (powerOfTwo < initialCapacity) {
+        powerOfTwo *= 2;
+    }
+    table.store(new Table(powerOfTwo), std::memory_order_release);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+LockFreeHashMap<K, V, Hash, KeyEqual>::~LockFreeHashMap() {
+    destroyTable(table.load(std::memory_order_relaxed));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename Q>
+const typename LockFreeHashMap<K, V, Hash, KeyEqual>::Node* LockFreeHashMap<K, V, Hash, KeyEqual>::lookup(const Q& key) const {
+    const Table* current = table.load(std::memory_order_acquire);
+    const Node* node = current->buckets[hash(key, current->capacity)].load(std::memory_order_acquire);
+    while (node != nullptr) {
+        if (hashmap_detail::keysEqual(keyEqual, node->key, key)) {
+            return node;
+        }
+        node = node->next.load(std::memory_order_acquire);
+    }
+    return nullptr;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void LockFreeHashMap<K, V, Hash, KeyEqual>::resizeAndRehash() {
+    Table* oldTable = table.load(std::memory_order_relaxed);
+    Table* newTable = new Table(oldTable->capacity * 2);
+
+    // Readers may still be walking the old chains, so the nodes are copied
+    // rather than relinked.
+    for (size_t i = 0; i < oldTable->capacity; ++i) {
+        for (Node* node = oldTable->buckets[i].load(std::memory_order_relaxed); node != nullptr;
+             node = node->next.load(std::memory_order_relaxed)) {
+            auto& bucket = newTable->buckets[hash(node->key, newTable->capacity)];
+            bucket.store(new Node(node->key, node->value, bucket.load(std::memory_order_relaxed)),
+                         std::memory_order_relaxed);
+        }
+    }
+
+    table.store(newTable, std::memory_order_release);
+    retired.retire(oldTable, &destroyTable);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void LockFreeHashMap<K, V, Hash, KeyEqual>::insert(const K& key, const V& value) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    Table* current = table.load(std::memory_order_relaxed);
+    if (static_cast<double>(numElements.load(std::memory_order_relaxed)) / current->capacity > LOAD_FACTOR_THRESHOLD) {
+        resizeAndRehash();
+        current = table.load(std::memory_order_relaxed);
+    }
+
+    std::atomic<Node*>* link = &current->buckets[hash(key, current->capacity)];
+    for (Node* node = link->load(std::memory_order_relaxed); node != nullptr; node = link->load(std::memory_order_relaxed)) {
+        if (hashmap_detail::keysEqual(keyEqual, node->key, key)) {
+            Node* replacement = new Node(node->key, value, node->next.load(std::memory_order_relaxed));
+            link->store(replacement, std::memory_order_release);
+            retired.retire(node);
+            retired.collect();
+            return;
+        }
+        link = &node->next;
+    }
+
+    std::atomic<Node*>& bucket = current->buckets[hash(key, current->capacity)];
+    bucket.store(new Node(key, value, bucket.load(std::memory_order_relaxed)), std::memory_order_release);
+    numElements.fetch_add(1, std::memory_order_relaxed);
+    retired.collect();
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool LockFreeHashMap<K, V, Hash, KeyEqual>::search(const K& key, V& valueOut) const {
+    EpochGuard guard;
+    const Node* node = lookup(key);
+    if (node == nullptr) {
+        return false;
+    }
+    valueOut = node->value;
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename Q, typename>
+bool LockFreeHashMap<K, V, Hash, KeyEqual>::search(const Q& key, V& valueOut) const {
+    EpochGuard guard;
+    const Node* node = lookup(key);
+    if (node == nullptr) {
+        return false;
+    }
+    valueOut = node->value;
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool LockFreeHashMap<K, V, Hash, KeyEqual>::remove(const K& key) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    Table* current = table.load(std::memory_order_relaxed);
+    std::atomic<Node*>* link = &current->buckets[hash(key, current->capacity)];
+    for (Node* node = link->load(std::memory_order_relaxed); node != nullptr; node = link->load(std::memory_order_relaxed)) {
+        if (hashmap_detail::keysEqual(keyEqual, node->key, key)) {
+            link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+            numElements.fetch_sub(1, std::memory_order_relaxed);
+            retired.retire(node);
+            retired.collect();
+            return true;
+        }
+        link = &node->next;
+    }
+    return false;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+size_t LockFreeHashMap<K, V, Hash, KeyEqual>::size() const {
+    return numElements.load(std::memory_order_relaxed);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void LockFreeHashMap<K, V, Hash, KeyEqual>::clear() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    Table* oldTable = table.load(std::memory_order_relaxed);
+    table.store(new Table(oldTable->capacity), std::memory_order_release);
+    numElements.store(0, std::memory_order_relaxed);
+    retired.retire(oldTable, &destroyTable);
+    retired.collect();
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void LockFreeHashMap<K, V, Hash, KeyEqual>::printStats() const {
+    EpochGuard guard;
+    const Table* current = table.load(std::memory_order_acquire);
+
+    size_t totalChainLength = 0;
+    size_t longestChain = 0;
+    size_t emptyBuckets = 0;
+
+    for (size_t i = 0; i < current->capacity; ++i) {
+        size_t chainLength = 0;
+        for (const Node* node = current->buckets[i].load(std::memory_order_acquire); node != nullptr;
+             node = node->next.load(std::memory_order_acquire)) {
+            chainLength++;
+        }
+        totalChainLength += chainLength;
+        if (chainLength > longestChain) {
+            longestChain = chainLength;
+        }
+        if (chainLength == 0) {
+            emptyBuckets++;
+        }
+    }
+
+    std::cout << "LockFreeHashMap Statistics:" << std::endl;
+    std::cout << "  Current Capacity: " << current->capacity << std::endl;
+    std::cout << "  Number of Elements: " << size() << std::endl;
+    std::cout << "  Load Factor: " << static_cast<double>(size()) / current->capacity << std::endl;
+    std::cout << "  Average Chain Length: " << static_cast<double>(totalChainLength) / current->capacity << std::endl;
+    std::cout << "  Longest Chain Length: " << longestChain << std::endl;
+    std::cout << "  Number of Empty Buckets: " << emptyBuckets << std::endl;
+}
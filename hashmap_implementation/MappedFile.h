@@ -0,0 +1,209 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only memory mapping of a whole file, released on destruction. Shared
+// by the snapshot formats (MappedHashMap, FrozenTrie) that are read in place.
+class MappedFile {
+public:
+    MappedFile() : base(nullptr), length(0) {}
+
+    explicit MappedFile(const std::string& path) : base(nullptr), length(0) {
+        map(path);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept : base(other.base), length(other.length) {
+#ifdef _WIN32
+        fileHandle = other.fileHandle;
+        mappingHandle = other.mappingHandle;
+        other.fileHandle = INVALID_HANDLE_VALUE;
+        other.mappingHandle = nullptr;
+#endif
+        other.base = nullptr;
+        other.length = 0;
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            base = other.base;
+            length = other.length;
+#ifdef _WIN32
+            fileHandle = other.fileHandle;
+            mappingHandle = other.mappingHandle;
+            other.fileHandle = INVALID_HANDLE_VALUE;
+            other.mappingHandle = nullptr;
+#endif
+            other.base = nullptr;
+            other.length = 0;
+        }
+        return *this;
+    }
+
+    ~MappedFile() {
+        unmap();
+    }
+
+    const char* data() const {
+        return base;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+private:
+    const char* base;
+    size_t length;
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#endif
+
+#ifdef _WIN32
+    void map(const std::string& path) {
+        // FILE_SHARE_DELETE lets replaceMappedFile() rename a new file over
+        // this one while it is mapped.
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Could not open " + path + ".");
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+            unmap();
+            throw std::runtime_error(path + " is empty or unreadable.");
+        }
+        length = static_cast<size_t>(fileSize.QuadPart);
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle == nullptr) {
+            unmap();
+            throw std::runtime_error("Could not map " + path + ".");
+        }
+        base = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (base == nullptr) {
+            unmap();
+            throw std::runtime_error("Could not map " + path + ".");
+        }
+    }
+
+    void unmap() {
+        if (base != nullptr) {
+            UnmapViewOfFile(base);
+        }
+        if (mappingHandle != nullptr) {
+            CloseHandle(mappingHandle);
+        }
+        if (fileHandle != INVALID_HANDLE_VALUE) {
+            CloseHandle(fileHandle);
+        }
+        base = nullptr;
+        length = 0;
+        mappingHandle = nullptr;
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    void map(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open " + path + ".");
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error(path + " is empty or unreadable.");
+        }
+        length = static_cast<size_t>(info.st_size);
+        // MAP_SHARED so every process mapping the file reads the same pages.
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            length = 0;
+            throw std::runtime_error("Could not map " + path + ".");
+        }
+        base = static_cast<const char*>(mapping);
+    }
+
+    void unmap() {
+        if (base != nullptr) {
+            ::munmap(const_cast<char*>(base), length);
+        }
+        base = nullptr;
+        length = 0;
+    }
+#endif
+};
+
+namespace mapped_file_detail {
+
+inline unsigned long processId() {
+#ifdef _WIN32
+    return static_cast<unsigned long>(GetCurrentProcessId());
+#else
+    return static_cast<unsigned long>(::getpid());
+#endif
+}
+
+// Moves from over to in one step, replacing any file already at to.
+inline bool renameOver(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+}
+
+// Writes path for the snapshot formats, whose files other processes may have
+// mapped. write(out) fills a temporary file next to path, which then replaces
+// path in a single rename: existing mappings keep the old file's pages, and
+// a process opening path sees either the old image or the whole new one,
+// never a partly written one.
+template <typename Write>
+void replaceMappedFile(const std::string& path, Write write) {
+    std::string temporary = path + ".tmp" + std::to_string(mapped_file_detail::processId());
+    try {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Could not open " + temporary + " for writing.");
+        }
+        write(out);
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("Could not write " + temporary + ".");
+        }
+    } catch (...) {
+        std::remove(temporary.c_str());
+        throw;
+    }
+    if (!mapped_file_detail::renameOver(temporary, path)) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Could not replace " + path + ".");
+    }
+}
+
+#endif
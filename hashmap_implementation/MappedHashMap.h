@@ -0,0 +1,245 @@
+#ifndef MAPPEDHASHMAP_H
+#define MAPPEDHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "HashMap.h"
+#include "MappedFile.h"
+#include "StringHashers.h"
+
+// On-disk snapshot of a string-to-string HashMap, written by HashMap::save()
+// and opened by HashMap::mapFile().
+//
+// The file is a header, an open-addressing slot array and a blob of key and
+// value bytes. Slots refer to strings by offset from the start of the file,
+// so the image is position independent: mapping it read-only is the whole
+// load, lookups run directly against the mapped pages, and every process that
+// maps the same file shares one page-cache copy. The layout is native-endian
+// and hashes keys with the WyHash in StringHashers.h, so a change to either
+// needs a new SNAPSHOT_VERSION.
+namespace snapshot_detail {
+
+constexpr char SNAPSHOT_MAGIC[8] = {'H', 'M', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t slotSize;
+    uint64_t slotCount;       // power of two
+    uint64_t elementCount;
+    uint64_t slotsOffset;
+    uint64_t fileSize;
+};
+
+struct Slot {
+    uint64_t hash;
+    uint64_t keyOffset;
+    uint64_t valueOffset;
+    uint32_t keyLength;       // EMPTY_SLOT marks an unused slot
+    uint32_t valueLength;
+};
+
+inline uint64_t hashKey(std::string_view key) {
+    return static_cast<uint64_t>(WyHash()(key));
+}
+
+// Writes entries (distinct keys) to path, replacing any existing file without
+// disturbing processes that have it mapped.
+inline void writeSnapshot(const std::string& path, const std::vector<std::pair<std::string_view, std::string_view>>& entries) {
+    uint64_t slotCount = 16;
+    while (slotCount < entries.size() * 2) {
+        slotCount *= 2;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.slotSize = sizeof(Slot);
+    header.slotCount = slotCount;
+    header.elementCount = entries.size();
+    header.slotsOffset = sizeof(Header);
+
+    std::vector<Slot> slots(slotCount, Slot{0, 0, 0, EMPTY_SLOT, 0});
+    uint64_t offset = header.slotsOffset + slotCount * sizeof(Slot);
+    for (const auto& entry : entries) {
+        if (entry.first.size() >= EMPTY_SLOT || entry.second.size() >= EMPTY_SLOT) {
+            throw std::length_error("Snapshot strings must be shorter than 4 GiB.");
+        }
+        uint64_t h = hashKey(entry.first);
+        uint64_t index = h & (slotCount - 1);
+        while (slots[index].keyLength != EMPTY_SLOT) {
+            index = (index + 1) & (slotCount - 1);
+        }
+        slots[index] = Slot{h, offset, offset + entry.first.size(), static_cast<uint32_t>(entry.first.size()),
+                            static_cast<uint32_t>(entry.second.size())};
+        offset += entry.first.size() + entry.second.size();
+    }
+    header.fileSize = offset;
+
+    replaceMappedFile(path, [&](std::ofstream& out) {
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(slots.data()), static_cast<std::streamsize>(slots.size() * sizeof(Slot)));
+        for (const auto& entry : entries) {
+            out.write(entry.first.data(), static_cast<std::streamsize>(entry.first.size()));
+            out.write(entry.second.data(), static_cast<std::streamsize>(entry.second.size()));
+        }
+    });
+}
+
+}
+
+// Read-only view of a snapshot file. Opening maps the file and checks the
+// header; nothing is parsed or copied, so open time does not depend on the
+// number of entries. The slots are instead checked as lookups reach them:
+// a probe never runs past slotCount slots, and a slot whose strings would lie
+// outside the file throws rather than being read. Values come back as
+// string_views into the mapping and stay valid for the lifetime of the
+// MappedHashMap.
+class MappedHashMap {
+public:
+    explicit MappedHashMap(const std::string& path) : file(path), base(file.data()) {
+        if (file.size() < sizeof(snapshot_detail::Header)) {
+            throw std::runtime_error(path + " is too small to be a HashMap snapshot.");
+        }
+        const snapshot_detail::Header* header = headerOf();
+        if (std::memcmp(header->magic, snapshot_detail::SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+            header->version != snapshot_detail::SNAPSHOT_VERSION || header->slotSize != sizeof(snapshot_detail::Slot)) {
+            throw std::runtime_error(path + " is not a compatible HashMap snapshot.");
+        }
+        // Written as divisions so that no product or sum can wrap around.
+        if (header->fileSize != file.size() || header->slotCount == 0 || (header->slotCount & (header->slotCount - 1)) != 0 ||
+            header->slotsOffset < sizeof(snapshot_detail::Header) || header->slotsOffset > file.size() ||
+            header->slotsOffset % alignof(snapshot_detail::Slot) != 0 ||
+            header->slotCount > (file.size() - header->slotsOffset) / sizeof(snapshot_detail::Slot) ||
+            header->elementCount >= header->slotCount) {
+            throw std::runtime_error(path + " is truncated or corrupt.");
+        }
+    }
+
+    bool search(std::string_view key, std::string_view& valueOut) const {
+        const snapshot_detail::Header* header = headerOf();
+        const snapshot_detail::Slot* slots = reinterpret_cast<const snapshot_detail::Slot*>(base + header->slotsOffset);
+        uint64_t mask = header->slotCount - 1;
+        uint64_t h = snapshot_detail::hashKey(key);
+
+        // save() always leaves empty slots, but a damaged file might not, so
+        // give up after visiting every slot once.
+        uint64_t index = h & mask;
+        for (uint64_t probes = 0; probes < header->slotCount; ++probes, index = (index + 1) & mask) {
+            const snapshot_detail::Slot& slot = slots[index];
+            if (slot.keyLength == snapshot_detail::EMPTY_SLOT) {
+                return false;
+            }
+            if (slot.hash == h && slot.keyLength == key.size()) {
+                if (!inFile(slot.keyOffset, slot.keyLength) || !inFile(slot.valueOffset, slot.valueLength)) {
+                    throw std::runtime_error("HashMap snapshot slot points outside the file.");
+                }
+                if (std::memcmp(base + slot.keyOffset, key.data(), key.size()) == 0) {
+                    valueOut = std::string_view(base + slot.valueOffset, slot.valueLength);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool search(std::string_view key, std::string& valueOut) const {
+        std::string_view value;
+        if (!search(key, value)) {
+            return false;
+        }
+        valueOut.assign(value.data(), value.size());
+        return true;
+    }
+
+    size_t size() const {
+        return static_cast<size_t>(headerOf()->elementCount);
+    }
+
+    void printStats() const {
+        const snapshot_detail::Header* header = headerOf();
+        std::cout << "MappedHashMap Statistics:" << std::endl;
+        std::cout << "  Number of Slots: " << header->slotCount << std::endl;
+        std::cout << "  Number of Elements: " << header->elementCount << std::endl;
+        std::cout << "  Load Factor: " << static_cast<double>(header->elementCount) / header->slotCount << std::endl;
+        std::cout << "  File Size: " << header->fileSize << " bytes" << std::endl;
+    }
+
+private:
+    // Moving a MappedFile keeps the mapping's address, so base stays valid
+    // when a MappedHashMap is moved.
+    MappedFile file;
+    const char* base;
+
+    const snapshot_detail::Header* headerOf() const {
+        return reinterpret_cast<const snapshot_detail::Header*>(base);
+    }
+
+    // Whether length bytes at offset lie inside the mapping, without
+    // overflowing on hostile values.
+    bool inFile(uint64_t offset, uint64_t length) const {
+        return offset <= file.size() && length <= file.size() - offset;
+    }
+};
+
+// HashMap::save() and HashMap::mapFile() live here rather than in the .tpp
+// files so that only code that actually uses snapshots pulls in the mapping
+// headers.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::save(const std::string& path) const {
+    static_assert(std::is_convertible<const K&, std::string_view>::value &&
+                  std::is_convertible<const V&, std::string_view>::value,
+                  "HashMap snapshots hold string keys and values");
+
+    std::vector<std::pair<std::string_view, std::string_view>> entries;
+    entries.reserve(numElements);
+    for (const auto& bucket : table) {
+        for (const auto& entry : bucket) {
+            entries.emplace_back(entry.pair.first, entry.pair.second);
+        }
+    }
+    for (const auto& bucket : oldTable) {
+        for (const auto& entry : bucket) {
+            entries.emplace_back(entry.pair.first, entry.pair.second);
+        }
+    }
+    snapshot_detail::writeSnapshot(path, entries);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Layout, typename SizePolicy, typename Allocator, typename Metrics>
+MappedHashMap HashMap<K, V, Hash, KeyEqual, Layout, SizePolicy, Allocator, Metrics>::mapFile(const std::string& path) {
+    return MappedHashMap(path);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+void HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::save(const std::string& path) const {
+    static_assert(std::is_convertible<const K&, std::string_view>::value &&
+                  std::is_convertible<const V&, std::string_view>::value,
+                  "HashMap snapshots hold string keys and values");
+
+    std::vector<std::pair<std::string_view, std::string_view>> entries;
+    entries.reserve(numElements);
+    for (size_t i = 0; i < capacity; ++i) {
+        if (ctrl[i] != EMPTY) {
+            entries.emplace_back(slots[i].first, slots[i].second);
+        }
+    }
+    snapshot_detail::writeSnapshot(path, entries);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename SizePolicy, typename Allocator, typename Metrics>
+MappedHashMap HashMap<K, V, Hash, KeyEqual, OpenAddressing, SizePolicy, Allocator, Metrics>::mapFile(const std::string& path) {
+    return MappedHashMap(path);
+}
+
+#endif
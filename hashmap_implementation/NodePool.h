@@ -0,0 +1,183 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Slab allocator for fixed-size nodes. Nodes are carved out of large slabs,
+// freed nodes go on an intrusive free list for reuse, and the slabs themselves
+// are only returned to the system all at once. Not thread-safe.
+class NodePool {
+public:
+    NodePool() : nodeSize(0), freeList(nullptr), bump(nullptr), bumpEnd(nullptr), liveNodes(0), nextSlabNodes(64) {}
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() {
+        releaseSlabs();
+    }
+
+    // Serves the first size it is asked for; other sizes return nullptr and
+    // the caller falls back to the global heap.
+    void* allocate(size_t size) {
+        size_t rounded = roundUp(size);
+        if (nodeSize == 0) {
+            nodeSize = rounded;
+        }
+        if (rounded != nodeSize) {
+            return nullptr;
+        }
+
+        liveNodes++;
+        if (freeList != nullptr) {
+            FreeNode* node = freeList;
+            freeList = node->next;
+            return node;
+        }
+        if (bump == bumpEnd) {
+            addSlab();
+        }
+        void* node = bump;
+        bump += nodeSize;
+        return node;
+    }
+
+    bool owns(size_t size) const {
+        return nodeSize != 0 && roundUp(size) == nodeSize;
+    }
+
+    void deallocate(void* node) {
+        FreeNode* freed = static_cast<FreeNode*>(node);
+        freed->next = freeList;
+        freeList = freed;
+        liveNodes--;
+    }
+
+    // Return every slab to the system once no node is in use, e.g. after the
+    // owning map has been cleared.
+    void releaseIfIdle() {
+        if (liveNodes == 0) {
+            releaseSlabs();
+        }
+    }
+
+    size_t slabCount() const {
+        return slabs.size();
+    }
+
+private:
+    // Slabs grow geometrically up to this many nodes each.
+    static constexpr size_t MAX_SLAB_NODES = 65536;
+
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    size_t nodeSize;
+    std::vector<void*> slabs;
+    FreeNode* freeList;
+    char* bump;
+    char* bumpEnd;
+    size_t liveNodes;
+    size_t nextSlabNodes;
+
+    static size_t roundUp(size_t size) {
+        size_t alignment = alignof(std::max_align_t);
+        size = std::max(size, sizeof(FreeNode));
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    void addSlab() {
+        char* slab = static_cast<char*>(::operator new(nodeSize * nextSlabNodes));
+        slabs.push_back(slab);
+        bump = slab;
+        bumpEnd = slab + nodeSize * nextSlabNodes;
+        nextSlabNodes = std::min(nextSlabNodes * 2, MAX_SLAB_NODES);
+    }
+
+    void releaseSlabs() {
+        for (void* slab : slabs) {
+            ::operator delete(slab);
+        }
+        slabs.clear();
+        freeList = nullptr;
+        bump = nullptr;
+        bumpEnd = nullptr;
+        nextSlabNodes = 64;
+    }
+};
+
+// Standard allocator over a shared NodePool. Rebound copies (std::list asks
+// for its node type) share the pool, and two allocators compare equal when
+// they share a pool, so nodes can be spliced between lists that use them.
+template <typename T>
+class NodePoolAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    NodePoolAllocator() : pool(std::make_shared<NodePool>()) {}
+
+    template <typename U>
+    NodePoolAllocator(const NodePoolAllocator<U>& other) : pool(other.pool) {}
+
+    T* allocate(size_t n) {
+        if (n == 1) {
+            if (void* node = pool->allocate(sizeof(T))) {
+                return static_cast<T*>(node);
+            }
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        if (n == 1 && pool->owns(sizeof(T))) {
+            pool->deallocate(p);
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+    NodePool& nodePool() const {
+        return *pool;
+    }
+
+    template <typename U>
+    bool operator==(const NodePoolAllocator<U>& other) const {
+        return pool == other.pool;
+    }
+
+    template <typename U>
+    bool operator!=(const NodePoolAllocator<U>& other) const {
+        return pool != other.pool;
+    }
+
+private:
+    template <typename U>
+    friend class NodePoolAllocator;
+
+    std::shared_ptr<NodePool> pool;
+};
+
+namespace hashmap_detail {
+
+// Lets HashMap::clear() hand an emptied pool's slabs back in one go; a no-op
+// for every other allocator.
+template <typename Allocator>
+void releaseIfIdle(const Allocator&) {}
+
+template <typename T>
+void releaseIfIdle(const NodePoolAllocator<T>& allocator) {
+    allocator.nodePool().releaseIfIdle();
+}
+
+}
+
+#endif
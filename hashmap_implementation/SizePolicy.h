@@ -0,0 +1,168 @@
+#ifndef SIZEPOLICY_H
+#define SIZEPOLICY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// Sizing policies decide how many buckets a HashMap has and how a hash code
+// is reduced to a bucket index. An instance describes one table:
+//
+//   static size_t nextCapacity(size_t current);  // capacity after growing
+//   explicit Policy(size_t capacity);            // capacity from nextCapacity
+//   size_t index(size_t hashCode) const;         // in [0, capacity)
+
+namespace sizing_detail {
+
+// High 64 bits of a 64x64-bit product.
+inline uint64_t multiplyHigh(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#elif defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+    return __umulh(a, b);
+#else
+    uint64_t aLow = a & 0xFFFFFFFFu, aHigh = a >> 32;
+    uint64_t bLow = b & 0xFFFFFFFFu, bHigh = b >> 32;
+    uint64_t cross = (aLow * bLow >> 32) + (aHigh * bLow & 0xFFFFFFFFu) + aLow * bHigh;
+    return aHigh * bHigh + (aHigh * bLow >> 32) + (cross >> 32);
+#endif
+}
+
+// Fold a hash code to the 32 bits the reciprocal modulus works on.
+inline uint32_t fold(size_t hashCode) {
+    uint64_t h = static_cast<uint64_t>(hashCode);
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+// Primes roughly doubling in size, each the first prime past twice the one
+// before it, up to the largest 32-bit prime.
+constexpr uint32_t PRIMES[] = {
+    3u, 7u, 17u, 37u, 79u, 163u, 331u, 673u, 1361u, 2729u, 5471u, 10949u,
+    21911u, 43853u, 87719u, 175447u, 350899u, 701819u, 1403641u, 2807303u,
+    5614657u, 11229331u, 22458671u, 44917381u, 89834777u, 179669557u,
+    359339171u, 718678369u, 1437356741u, 2874713497u, 4294967291u
+};
+
+constexpr size_t PRIME_COUNT = sizeof(PRIMES) / sizeof(PRIMES[0]);
+
+// Lemire's fastmod: with M = ceil(2^64 / d), a mod d == mulhi(M * a, d) for
+// any 32-bit a and d, so the divide happens here at compile time instead.
+constexpr std::array<uint64_t, PRIME_COUNT> makeReciprocals() {
+    std::array<uint64_t, PRIME_COUNT> reciprocals{};
+    for (size_t i = 0; i < PRIME_COUNT; ++i) {
+        reciprocals[i] = UINT64_C(0xFFFFFFFFFFFFFFFF) / PRIMES[i] + 1;
+    }
+    return reciprocals;
+}
+
+constexpr std::array<uint64_t, PRIME_COUNT> RECIPROCALS = makeReciprocals();
+
+}
+
+// Prime bucket counts from a fixed table, reduced with a precomputed
+// reciprocal instead of a hardware divide.
+class PrimeSizing {
+public:
+    static size_t nextCapacity(size_t current) {
+        for (size_t i = 0; i < sizing_detail::PRIME_COUNT; ++i) {
+            if (sizing_detail::PRIMES[i] > current * 2) {
+                return sizing_detail::PRIMES[i];
+            }
+        }
+        throw std::length_error("HashMap capacity exceeds the prime table.");
+    }
+
+    PrimeSizing() : prime(sizing_detail::PRIMES[0]), reciprocal(sizing_detail::RECIPROCALS[0]) {}
+
+    explicit PrimeSizing(size_t capacity) : PrimeSizing() {
+        for (size_t i = 0; i < sizing_detail::PRIME_COUNT; ++i) {
+            if (sizing_detail::PRIMES[i] == capacity) {
+                prime = sizing_detail::PRIMES[i];
+                reciprocal = sizing_detail::RECIPROCALS[i];
+                return;
+            }
+        }
+        throw std::invalid_argument("PrimeSizing capacity must come from nextCapacity().");
+    }
+
+    size_t index(size_t hashCode) const {
+        return static_cast<size_t>(sizing_detail::multiplyHigh(reciprocal * sizing_detail::fold(hashCode), prime));
+    }
+
+private:
+    uint64_t prime;
+    uint64_t reciprocal;
+};
+
+// Power-of-two bucket counts. Fibonacci hashing (multiply by 2^64 / phi and
+// keep the top bits) mixes the whole hash into the index, so weak hashes do
+// not collapse onto a few buckets the way a plain mask would.
+class PowerOfTwoSizing {
+public:
+    static size_t nextCapacity(size_t current) {
+        size_t capacity = 2;
+        while (capacity <= current * 2) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    PowerOfTwoSizing() : shift(63) {}
+
+    explicit PowerOfTwoSizing(size_t capacity) : shift(64) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("PowerOfTwoSizing capacity must be a power of two.");
+        }
+        while (capacity > 1) {
+            capacity >>= 1;
+            shift--;
+        }
+    }
+
+    size_t index(size_t hashCode) const {
+        return static_cast<size_t>((static_cast<uint64_t>(hashCode) * UINT64_C(0x9E3779B97F4A7C15)) >> shift);
+    }
+
+private:
+    unsigned shift;
+};
+
+// The original scheme: trial-division primes and a hardware modulo. Kept as a
+// baseline for benchmarks.
+class DivisionSizing {
+public:
+    static size_t nextCapacity(size_t current) {
+        size_t newCapacity = current * 2 + 1;
+        while (true) {
+            bool isPrime = true;
+            for (size_t i = 2; i * i <= newCapacity; ++i) {
+                if (newCapacity % i == 0) {
+                    isPrime = false;
+                    break;
+                }
+            }
+            if (isPrime) {
+                return newCapacity;
+            }
+            newCapacity += 2;
+        }
+    }
+
+    DivisionSizing() : capacity(1) {}
+
+    explicit DivisionSizing(size_t capacity) : capacity(capacity) {}
+
+    size_t index(size_t hashCode) const {
+        return hashCode % capacity;
+    }
+
+private:
+    size_t capacity;
+};
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef STRINGHASHERS_H
+#define STRINGHASHERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "SizePolicy.h"
+
+// Fast string hash functors for HashMap's Hash parameter. They follow the
+// structure of FNV-1a, wyhash and XXH3 but are not bit-compatible with the
+// reference implementations, so never persist their output. All of them take
+// std::string_view and are transparent, so string_view lookups still work.
+
+namespace hasher_detail {
+
+inline uint64_t read64(const char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t read32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Full 64x64 -> 128-bit multiply folded back to 64 bits.
+inline uint64_t multiplyFold(uint64_t a, uint64_t b) {
+    return (a * b) ^ sizing_detail::multiplyHigh(a, b);
+}
+
+}
+
+// One multiply per byte; tiny and predictable, best for very short keys.
+struct Fnv1aHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view key) const {
+        uint64_t h = 0xCBF29CE484222325ull;
+        for (char ch : key) {
+            h ^= static_cast<unsigned char>(ch);
+            h *= 0x100000001B3ull;
+        }
+        return static_cast<size_t>(h);
+    }
+};
+
+// wyhash-style: consumes 16 bytes per 128-bit multiply-fold.
+struct WyHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view key) const {
+        static constexpr uint64_t SECRET0 = 0xA0761D6478BD642Full;
+        static constexpr uint64_t SECRET1 = 0xE7037ED1A0B428DBull;
+        static constexpr uint64_t SECRET2 = 0x8EBC6AF09C88C6E3ull;
+
+        const char* p = key.data();
+        size_t length = key.size();
+        uint64_t seed = SECRET0 ^ length;
+        uint64_t a;
+        uint64_t b;
+
+        if (length <= 16) {
+            if (length >= 4) {
+                a = (hasher_detail::read32(p) << 32) | hasher_detail::read32(p + ((length >> 3) << 2));
+                b = (hasher_detail::read32(p + length - 4) << 32) |
+                    hasher_detail::read32(p + length - 4 - ((length >> 3) << 2));
+            } else if (length > 0) {
+                a = (static_cast<uint64_t>(static_cast<unsigned char>(p[0])) << 16) |
+                    (static_cast<uint64_t>(static_cast<unsigned char>(p[length >> 1])) << 8) |
+                    static_cast<unsigned char>(p[length - 1]);
+                b = 0;
+            } else {
+                a = 0;
+                b = 0;
+            }
+        } else {
+            size_t remaining = length;
+            while (remaining > 16) {
+                seed = hasher_detail::multiplyFold(hasher_detail::read64(p) ^ SECRET1,
+                                                   hasher_detail::read64(p + 8) ^ seed);
+                p += 16;
+                remaining -= 16;
+            }
+            a = hasher_detail::read64(p + remaining - 16);
+            b = hasher_detail::read64(p + remaining - 8);
+        }
+
+        return static_cast<size_t>(hasher_detail::multiplyFold(SECRET1 ^ length,
+                                                               hasher_detail::multiplyFold(a ^ SECRET1, b ^ seed) ^ SECRET2));
+    }
+};
+
+// XXH3-style: separate short-input paths, 16-byte mixing rounds, and a final
+// xorshift-multiply avalanche.
+struct Xxh3Hash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view key) const {
+        static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+        static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+        static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ull;
+        static constexpr uint64_t SECRET[4] = {
+            0xBE4BA423396CFEB8ull, 0x1CAD21F72C81017Cull, 0xDB979083E96DD4DEull, 0x1F67B3B7A4A44072ull
+        };
+
+        const char* p = key.data();
+        size_t length = key.size();
+        uint64_t acc;
+
+        if (length == 0) {
+            acc = SECRET[0] ^ SECRET[1];
+        } else if (length <= 3) {
+            uint64_t combined = (static_cast<uint64_t>(static_cast<unsigned char>(p[0])) << 16) |
+                                (static_cast<uint64_t>(static_cast<unsigned char>(p[length >> 1])) << 24) |
+                                static_cast<unsigned char>(p[length - 1]) | (static_cast<uint64_t>(length) << 8);
+            acc = (combined ^ (SECRET[0] >> 32)) * PRIME1;
+        } else if (length <= 8) {
+            uint64_t combined = hasher_detail::read32(p + length - 4) + (hasher_detail::read32(p) << 32);
+            acc = (combined ^ SECRET[1]) * PRIME2 + length;
+        } else if (length <= 16) {
+            uint64_t low = hasher_detail::read64(p) ^ SECRET[2];
+            uint64_t high = hasher_detail::read64(p + length - 8) ^ SECRET[3];
+            acc = length + low + high + hasher_detail::multiplyFold(low, high);
+        } else {
+            // Every block gets its own secret pair so that equal blocks at
+            // different offsets do not cancel out in the sum.
+            acc = length * PRIME1;
+            uint64_t block = 0;
+            for (size_t offset = 0; offset + 16 <= length; offset += 16, ++block) {
+                acc += mix16(p + offset, SECRET[0] + block * PRIME2, SECRET[1] - block * PRIME1);
+            }
+            acc += mix16(p + length - 16, SECRET[2], SECRET[3]);
+        }
+
+        acc ^= acc >> 37;
+        acc *= PRIME3;
+        acc ^= acc >> 32;
+        return static_cast<size_t>(acc);
+    }
+
+private:
+    static uint64_t mix16(const char* p, uint64_t secretLow, uint64_t secretHigh) {
+        return hasher_detail::multiplyFold(hasher_detail::read64(p) ^ secretLow,
+                                           hasher_detail::read64(p + 8) ^ secretHigh);
+    }
+};
+
+#endif
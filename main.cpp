@@ -6,7 +6,18 @@
 #include <sstream>
 #include <algorithm> 
 #include <functional>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include "hashmap_implementation/HashMap.h"
+#include "hashmap_implementation/ConcurrentHashMap.h"
+#include "hashmap_implementation/LockFreeHashMap.h"
+#include "hashmap_implementation/BoundedHashMap.h"
+#include "hashmap_implementation/MappedHashMap.h"
+#include "hashmap_implementation/StringHashers.h"
 #include "trie_implementation/trie.h"
 
 struct CountyData {
@@ -81,9 +92,11 @@ void displayMenu()
     std::cout << "6. Search for exact match in Trie" << std::endl;
     std::cout << "7. Search for prefix match in Trie" << std::endl;
     std::cout << "8. Search for exact match in Hashmap" << std::endl;
-    std::cout << "9. Exit" << std::endl;
+    std::cout << "9. Run Hashmap benchmarks" << std::endl;
+    std::cout << "10. Run Trie benchmarks" << std::endl;
+    std::cout << "11. Exit" << std::endl;
     std::cout << "=====================================================" << std::endl;
-    std::cout << "Please enter a number from 1-9 as your choice: " << std::endl;
+    std::cout << "Please enter a number from 1-11 as your choice: " << std::endl;
 
 }
 
@@ -105,6 +118,7 @@ void useTrie(Trie& countyTrie, std::vector<CountyData>& dataset)
     std::cout << "Total Insertion Time: " << duration_trie_insert.count() << " ms" << std::endl;
     std::cout << "Average Insertion Time: " << (double)duration_trie_insert.count() / dataset.size() << " ms" << std::endl;
 
+    countyTrie.printStats();
 }
 
 //Takes in a Trie and county name, performs exact search, and displays results and time
@@ -123,6 +137,20 @@ void trieExactSearch(Trie& countyTrie, std::string& county_name)
     {
         std::cout << "Could Not Find: " << county_name << std::endl;
 
+        //offer the closest spellings, one line per county
+        std::vector<TrieFuzzyMatch> near = countyTrie.searchFuzzy(county_name, 2);
+        std::vector<std::string> suggestions;
+        for (auto& match : near)
+        {
+            if (suggestions.size() < 5 && std::find(suggestions.begin(), suggestions.end(), match.word) == suggestions.end())
+            {
+                suggestions.push_back(match.word);
+            }
+        }
+        for (auto& suggestion : suggestions)
+        {
+            std::cout << "Did you mean: " << suggestion << std::endl;
+        }
     }
     else
     {
@@ -167,8 +195,12 @@ void triePrefixSearch(Trie& countyTrie, std::string& county_prefix)
     }
     else
     {
-        std:: cout << "Found Entry(s) with Prefix: " << county_prefix << std::endl;
-        //put logic here
+        std:: cout << "Found " << countyTrie.countPrefix(county_prefix) << " Entry(s) with Prefix: " << county_prefix << std::endl;
+        std::cout << "Most Populous Matches:" << std::endl;
+        for (auto& match : countyTrie.topK(county_prefix, 5))
+        {
+            std::cout << match.word << ", " << match.state << ", Population: " << match.population << std::endl;
+        }
         std::cout << "Print Results? (y/n)" << std::endl;
         char choice;
         std::cin >> choice;
@@ -213,42 +245,58 @@ void trieInsert(Trie& countyTrie)
 
 // Hashmap Functions
 
-void useHashMap(HashMap<std::string, std::string>& countyMap, std::vector<CountyData>& dataset)
+//County data is bulk loaded, so nodes come from a pool rather than one heap allocation each,
+//and the map keeps operation counters so printStats() can report them
+using CountyMap = HashMap<std::string, std::string, std::hash<std::string>, std::equal_to<std::string>, SeparateChaining,
+                          PrimeSizing, NodePoolAllocator<std::pair<std::string, std::string>>, CountingMetrics>;
+
+void useHashMap(CountyMap& countyMap, std::vector<CountyData>& dataset)
 {
 
     std::cout << "Testing insertion..." << std::endl;
     auto start = std::chrono::high_resolution_clock::now();
-    for (const auto& row : dataset) {
-        countyMap.insert(row.countyName, row.stateName);
+    if (countyMap.size() == 0)
+    {
+        //an empty map is built straight from the rows by the bulk-build constructor, which sizes the table once up front
+        countyMap = CountyMap(dataset.begin(), dataset.end(), [](const CountyData& row) {
+            return std::make_pair(row.countyName, row.stateName);
+        });
+    }
+    else
+    {
+        //loading again mostly overwrites keys that are already there, so size for the larger of the two
+        countyMap.reserve(std::max(countyMap.size(), dataset.size()));
+        for (const auto& row : dataset) {
+            countyMap.insert(row.countyName, row.stateName);
+        }
     }
     auto end = std::chrono::high_resolution_clock::now();
-    auto duration_insert = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    std::cout << "Total insertion time: " << duration_insert.count() << " ms" << std::endl;
-    std::cout << "Average insertion time: " << (double)duration_insert.count() / dataset.size() << " ms per entry" << std::endl;
+    auto duration_insert = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Total insertion time: " << duration_insert.count() << " us" << std::endl;
+    std::cout << "Average insertion time: " << (double)duration_insert.count() / dataset.size() << " us per entry" << std::endl;
 
     countyMap.printStats();
 }
 
-void hashmapExactSearch(HashMap<std::string, std::string>& countyMap, std::string& county_name)
+void hashmapExactSearch(CountyMap& countyMap, std::string& county_name)
 {
     std::cout << "\nTesting search..." << std::endl;
-    std::string valueOut;
     std::string existingKey = "Alachua County";
 
     auto start = std::chrono::high_resolution_clock::now();
-    bool found_existing = countyMap.search(county_name, valueOut);
+    const std::string* state = countyMap.find(county_name);
     auto end = std::chrono::high_resolution_clock::now();
     auto duration_search_existing = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 
-    if (found_existing) {
-        std::cout << "Found '" << county_name << "'. State: '" << valueOut << "'. Search took " << duration_search_existing.count() << " us." << std::endl;
+    if (state != nullptr) {
+        std::cout << "Found '" << county_name << "'. State: '" << *state << "'. Search took " << duration_search_existing.count() << " us." << std::endl;
     } else {
         std::cout << "Did not find '" << county_name << "'. Search took " << duration_search_existing.count() << " us." << std::endl;
     }
 
 }
 
-void hashmapInsert(HashMap<std::string, std::string>& countyMap)
+void hashmapInsert(CountyMap& countyMap)
 {
     std::string county_insert_name;
     std::string county_insert_state;
@@ -269,18 +317,912 @@ void hashmapInsert(HashMap<std::string, std::string>& countyMap)
     std::cout << "Total insertion time: " << duration_insert.count() << " ms" << std::endl;
 }
 
+// Benchmark Functions
+
+//Returns targetSize distinct keys made by suffixing copies of the county names with " #<copy>"
+std::vector<std::string> makeBenchmarkKeys(std::vector<CountyData>& dataset, size_t targetSize)
+{
+    std::vector<std::string> keys;
+    keys.reserve(targetSize);
+    for (size_t copy = 0; keys.size() < targetSize; copy++)
+    {
+        for (size_t i = 0; i < dataset.size() && keys.size() < targetSize; i++)
+        {
+            keys.push_back(dataset[i].countyName + " #" + std::to_string(copy));
+        }
+    }
+    return keys;
+}
+
+//Starts threadCount threads that each make lookupsPerThread calls of search(query, valueOut) over queries,
+//starting at different offsets, and returns the total lookups per second across all of them
+template <typename Search>
+double timeParallelReads(size_t threadCount, std::vector<std::string>& queries, size_t lookupsPerThread, Search search)
+{
+    std::atomic<bool> go(false);
+    std::atomic<size_t> found(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            std::string valueOut;
+            size_t hits = 0;
+            size_t offset = t * queries.size() / threadCount;
+            while (!go.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < lookupsPerThread; i++)
+            {
+                hits += search(queries[(offset + i) % queries.size()], valueOut);
+            }
+            found += hits;
+        });
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    if (found != threadCount * lookupsPerThread)
+    {
+        std::cout << "  (only " << found << " of " << threadCount * lookupsPerThread << " lookups found their key)" << std::endl;
+    }
+    return (double)threadCount * lookupsPerThread / duration.count() * 1e9;
+}
+
+//Compares read throughput from 1 up to one thread per hardware thread, for a single HashMap behind a mutex,
+//the sharded ConcurrentHashMap and the lock-free LockFreeHashMap; with perfect scaling the throughput grows
+//with the thread count
+void concurrentReadBenchmark(std::vector<CountyData>& dataset)
+{
+    const size_t mapSize = 1000000;
+    const size_t lookupsPerThread = 1000000;
+    size_t maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    std::cout << "\nConcurrent read scaling benchmark (" << mapSize << " keys, " << lookupsPerThread
+              << " lookups per thread, up to " << maxThreads << " threads)" << std::endl;
+    std::vector<std::string> keys = makeBenchmarkKeys(dataset, mapSize);
+    std::vector<std::string> queries = keys;
+    std::shuffle(queries.begin(), queries.end(), std::mt19937(42));
+
+    std::mutex lockedMutex;
+    HashMap<std::string, std::string> lockedMap;
+    ConcurrentHashMap<std::string, std::string> shardedMap;
+    LockFreeHashMap<std::string, std::string> lockFreeMap;
+    for (auto& key : keys)
+    {
+        lockedMap.insert(key, key);
+        shardedMap.insert(key, key);
+        lockFreeMap.insert(key, key);
+    }
+
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    for (size_t threads : threadCounts)
+    {
+        double locked = timeParallelReads(threads, queries, lookupsPerThread, [&](const std::string& key, std::string& valueOut)
+        {
+            std::lock_guard<std::mutex> lock(lockedMutex);
+            return lockedMap.search(key, valueOut);
+        });
+        double sharded = timeParallelReads(threads, queries, lookupsPerThread, [&](const std::string& key, std::string& valueOut)
+        {
+            return shardedMap.search(key, valueOut);
+        });
+        double lockFree = timeParallelReads(threads, queries, lookupsPerThread, [&](const std::string& key, std::string& valueOut)
+        {
+            return lockFreeMap.search(key, valueOut);
+        });
+        std::cout << "  " << threads << " thread(s): mutex + HashMap " << locked / 1e6 << " M lookups/s, ConcurrentHashMap "
+                  << sharded / 1e6 << " M lookups/s, LockFreeHashMap " << lockFree / 1e6 << " M lookups/s" << std::endl;
+    }
+}
+
+//Builds a map of the given type from keys and times search() and searchBatch at batch sizes 1..256 on queries
+template <typename Map>
+void benchmarkBatchedSearch(const std::string& mapName, std::vector<std::string>& keys, std::vector<std::string>& queries)
+{
+    Map benchMap;
+    for (auto& key : keys)
+    {
+        benchMap.insert(key, key);
+    }
+
+    std::cout << "  " << mapName << std::endl;
+    size_t queryCount = queries.size();
+    size_t found = 0;
+    std::string valueOut;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (auto& query : queries)
+    {
+        found += benchMap.search(query, valueOut);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    std::cout << "    search():          " << (double)duration.count() / queryCount << " ns per lookup (" << found << " found)" << std::endl;
+
+    std::vector<const std::string*> results(queryCount);
+    for (size_t batchSize = 1; batchSize <= 256; batchSize *= 2)
+    {
+        found = 0;
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t base = 0; base < queryCount; base += batchSize)
+        {
+            size_t count = std::min(batchSize, queryCount - base);
+            found += benchMap.searchBatch(&queries[base], count, &results[base]);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+        std::cout << "    searchBatch(" << batchSize << "): " << (batchSize < 10 ? "  " : batchSize < 100 ? " " : "")
+                  << (double)duration.count() / queryCount << " ns per lookup (" << found << " found)" << std::endl;
+    }
+}
+
+//Compares one-at-a-time search with searchBatch at batch sizes 1..256 on a map too large for the cache,
+//for the chained and the flat layout
+void hashmapBatchBenchmark(std::vector<CountyData>& dataset)
+{
+    const size_t mapSize = 1000000;
+    const size_t queryCount = 1000000;
+
+    std::cout << "\nBatched search benchmark (" << mapSize << " keys, " << queryCount << " lookups)" << std::endl;
+    std::vector<std::string> keys = makeBenchmarkKeys(dataset, mapSize);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+    std::vector<std::string> queries;
+    queries.reserve(queryCount);
+    for (size_t i = 0; i < queryCount; i++)
+    {
+        queries.push_back(keys[pick(rng)]);
+    }
+
+    benchmarkBatchedSearch<HashMap<std::string, std::string>>("HashMap (SeparateChaining)", keys, queries);
+    benchmarkBatchedSearch<FlatHashMap<std::string, std::string>>("FlatHashMap (OpenAddressing)", keys, queries);
+}
+
+//Builds a map of the given type from keys and returns the average time of looking up each query
+template <typename Map, typename Key>
+double timeLookups(std::vector<Key>& keys, std::vector<Key>& queries, size_t& found)
+{
+    Map benchMap;
+    for (auto& key : keys)
+    {
+        benchMap.insert(key, key);
+    }
+
+    found = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (auto& query : queries)
+    {
+        found += benchMap.find(query) != nullptr;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    return (double)duration.count() / queries.size();
+}
+
+template <typename Sizing>
+using StringSizingMap = HashMap<std::string, std::string, std::hash<std::string>, std::equal_to<std::string>, SeparateChaining, Sizing>;
+
+template <typename Sizing>
+using IntegerSizingMap = HashMap<uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>, SeparateChaining, Sizing>;
+
+//Compares the trial-division/modulo sizing with the prime-table and power-of-two sizing policies, and the
+//chained layout with the flat open-addressing one
+void hashmapSizingBenchmark(std::vector<CountyData>& dataset)
+{
+    const size_t mapSize = 1000000;
+    const size_t queryCount = 1000000;
+
+    std::cout << "\nSizing policy benchmark (" << mapSize << " keys, " << queryCount << " lookups)" << std::endl;
+
+    std::mt19937_64 rng(42);
+    std::vector<std::string> stringKeys = makeBenchmarkKeys(dataset, mapSize);
+    std::vector<uint64_t> integerKeys(mapSize);
+    for (auto& key : integerKeys)
+    {
+        key = rng();
+    }
+
+    std::uniform_int_distribution<size_t> pick(0, mapSize - 1);
+    std::vector<std::string> stringQueries;
+    std::vector<uint64_t> integerQueries;
+    for (size_t i = 0; i < queryCount; i++)
+    {
+        size_t index = pick(rng);
+        stringQueries.push_back(stringKeys[index]);
+        integerQueries.push_back(integerKeys[index]);
+    }
+
+    size_t found = 0;
+    double nanoseconds = timeLookups<StringSizingMap<DivisionSizing>>(stringKeys, stringQueries, found);
+    std::cout << "  string keys, DivisionSizing:    " << nanoseconds << " ns per lookup (" << found << " found)" << std::endl;
+    nanoseconds = timeLookups<StringSizingMap<PrimeSizing>>(stringKeys, stringQueries, found);
+    std::cout << "  string keys, PrimeSizing:       " << nanoseconds << " ns per lookup (" << found << " found)" << std::endl;
+    nanoseconds = timeLookups<StringSizingMap<PowerOfTwoSizing>>(stringKeys, stringQueries, found);
+    std::cout << "  string keys, PowerOfTwoSizing:  " << nanoseconds << " ns per lookup (" << found << " found)" << std::endl;
+    nanoseconds = timeLookups<FlatHashMap<std::string, std::string>>(stringKeys, stringQueries, found);
+    std::cout << "  string keys, FlatHashMap:       " << nanoseconds << " ns per lookup (" << found << " found)" << std::endl;
+
+    nanoseconds = timeLookups<IntegerSizingMap<DivisionSizing>>(integerKeys, integerQueries, found);
+    std::cout << "  integer keys, DivisionSizing:   " << nanoseconds << " ns per lookup (" << found << " found)" << std::endl;
+    nanoseconds = timeLookups<IntegerSizingMap<PrimeSizing>>(integerKeys, integerQueries, found);
+    std::cout << "  integer keys, PrimeSizing:      " << nanoseconds << " ns per lookup (" << found << " found)" << std::endl;
+    nanoseconds = timeLookups<IntegerSizingMap<PowerOfTwoSizing>>(integerKeys, integerQueries, found);
+    std::cout << "  integer keys, PowerOfTwoSizing: " << nanoseconds << " ns per lookup (" << found << " found)" << std::endl;
+    nanoseconds = timeLookups<FlatHashMap<uint64_t, uint64_t>>(integerKeys, integerQueries, found);
+    std::cout << "  integer keys, FlatHashMap:      " << nanoseconds << " ns per lookup (" << found << " found)" << std::endl;
+}
+
+//Times building, clearing and destroying a map of the given type from keys
+template <typename Map>
+void benchmarkNodeAllocation(const std::string& mapName, std::vector<uint64_t>& keys)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    Map* benchMap = new Map();
+    for (auto& key : keys)
+    {
+        benchMap->insert(key, key);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration_build = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+    start = std::chrono::high_resolution_clock::now();
+    benchMap->clear();
+    end = std::chrono::high_resolution_clock::now();
+    auto duration_clear = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+    for (auto& key : keys)
+    {
+        benchMap->insert(key, key);
+    }
+    start = std::chrono::high_resolution_clock::now();
+    delete benchMap;
+    end = std::chrono::high_resolution_clock::now();
+    auto duration_destroy = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+    std::cout << "  " << mapName << ": build " << duration_build.count() << " ms, clear " << duration_clear.count()
+              << " ms, destroy " << duration_destroy.count() << " ms" << std::endl;
+}
+
+//Compares per-node heap allocation with the pooled node allocator
+void hashmapPoolBenchmark()
+{
+    const size_t mapSize = 5000000;
+
+    std::cout << "\nNode allocation benchmark (" << mapSize << " integer keys)" << std::endl;
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> keys(mapSize);
+    for (auto& key : keys)
+    {
+        key = rng();
+    }
+
+    benchmarkNodeAllocation<HashMap<uint64_t, uint64_t>>("HashMap      ", keys);
+    benchmarkNodeAllocation<PooledHashMap<uint64_t, uint64_t>>("PooledHashMap", keys);
+}
+
+//Compares lookups in a mutable map with the frozen perfect-hash copy of it, for present and absent keys
+void hashmapFreezeBenchmark(std::vector<CountyData>& dataset)
+{
+    const size_t mapSize = 1000000;
+
+    std::cout << "\nFrozen map benchmark (" << mapSize << " keys)" << std::endl;
+    std::vector<std::string> keys = makeBenchmarkKeys(dataset, mapSize);
+    HashMap<std::string, std::string> benchMap;
+    benchMap.reserve(keys.size());
+    for (auto& key : keys)
+    {
+        benchMap.insert(key, key);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    FrozenHashMap<std::string, std::string> frozenMap = benchMap.freeze();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration_freeze = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "  freeze(): " << duration_freeze.count() << " ms" << std::endl;
+
+    std::mt19937 rng(42);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::vector<std::string> misses;
+    misses.reserve(keys.size());
+    for (auto& key : keys)
+    {
+        misses.push_back(key + "?");
+    }
+
+    size_t found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (auto& key : keys)
+    {
+        found += benchMap.find(key) != nullptr;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    std::cout << "  HashMap hits:       " << (double)duration.count() / keys.size() << " ns per lookup (" << found << " found)" << std::endl;
+
+    found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (auto& key : keys)
+    {
+        found += frozenMap.find(key) != nullptr;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    std::cout << "  FrozenHashMap hits: " << (double)duration.count() / keys.size() << " ns per lookup (" << found << " found)" << std::endl;
+
+    found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (auto& key : misses)
+    {
+        found += benchMap.find(key) != nullptr;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    std::cout << "  HashMap misses:       " << (double)duration.count() / misses.size() << " ns per lookup (" << found << " found)" << std::endl;
+
+    found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (auto& key : misses)
+    {
+        found += frozenMap.find(key) != nullptr;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    std::cout << "  FrozenHashMap misses: " << (double)duration.count() / misses.size() << " ns per lookup (" << found << " found)" << std::endl;
+
+    frozenMap.printStats();
+}
+
+//Saves a large map as a snapshot, then compares rebuilding it by insertion with mapping the snapshot
+void hashmapSnapshotBenchmark(std::vector<CountyData>& dataset)
+{
+    const size_t mapSize = 1000000;
+    const std::string snapshotPath = "hashmap_snapshot.bin";
+
+    std::cout << "\nSnapshot benchmark (" << mapSize << " keys)" << std::endl;
+    std::vector<std::string> keys = makeBenchmarkKeys(dataset, mapSize);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    HashMap<std::string, std::string> benchMap;
+    for (auto& key : keys)
+    {
+        benchMap.insert(key, key);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration_build = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "  build by insertion: " << duration_build.count() << " ms" << std::endl;
+
+    start = std::chrono::high_resolution_clock::now();
+    benchMap.save(snapshotPath);
+    end = std::chrono::high_resolution_clock::now();
+    auto duration_save = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "  save():             " << duration_save.count() << " ms" << std::endl;
+
+    {
+        start = std::chrono::high_resolution_clock::now();
+        MappedHashMap mappedMap = HashMap<std::string, std::string>::mapFile(snapshotPath);
+        end = std::chrono::high_resolution_clock::now();
+        auto duration_map = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        std::cout << "  mapFile():          " << duration_map.count() << " us" << std::endl;
+
+        size_t found = 0;
+        std::string_view value;
+        start = std::chrono::high_resolution_clock::now();
+        for (auto& key : keys)
+        {
+            found += mappedMap.search(key, value);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+        std::cout << "  mapped lookups:     " << (double)duration.count() / keys.size() << " ns per lookup (" << found << " found)" << std::endl;
+    }
+
+    std::remove(snapshotPath.c_str());
+}
+
+//Times exact lookups of absent keys in a map or trie, counting any that are found, and returns the average in nanoseconds
+template <typename Lookup>
+double timeMisses(std::vector<std::string>& misses, Lookup lookup, size_t& found)
+{
+    found = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (auto& key : misses)
+    {
+        found += lookup(key);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    return (double)duration.count() / misses.size();
+}
+
+//Compares lookups of absent keys with and without a Bloom filter in front of the HashMap and the Trie
+void bloomFilterBenchmark(std::vector<CountyData>& dataset)
+{
+    const size_t mapSize = 1000000;
+    const size_t bitsPerKey = 10;
+
+    std::cout << "\nBloom filter benchmark (" << bitsPerKey << " bits per key)" << std::endl;
+    std::vector<std::string> keys = makeBenchmarkKeys(dataset, mapSize);
+    HashMap<std::string, std::string> benchMap;
+    benchMap.reserve(keys.size());
+    for (auto& key : keys)
+    {
+        benchMap.insert(key, key);
+    }
+
+    std::mt19937 rng(42);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::vector<std::string> misses;
+    misses.reserve(keys.size());
+    for (auto& key : keys)
+    {
+        misses.push_back(key + "?");
+    }
+
+    size_t found = 0;
+    auto mapLookup = [&](std::string& key) { return benchMap.find(key) != nullptr; };
+    double average = timeMisses(misses, mapLookup, found);
+    std::cout << "  HashMap misses, no filter: " << average << " ns per lookup (" << found << " found)" << std::endl;
+    benchMap.setBloomFilter(bitsPerKey);
+    average = timeMisses(misses, mapLookup, found);
+    std::cout << "  HashMap misses, filtered:  " << average << " ns per lookup (" << found << " found, "
+              << benchMap.stats().filterRejects << " of " << misses.size() << " rejected by the filter)" << std::endl;
+
+    Trie benchTrie;
+    std::vector<std::string> trieMisses;
+    for (auto& row : dataset)
+    {
+        benchTrie.insert(row.countyName, row.stateName, row.population);
+        trieMisses.push_back(row.countyName + "s");
+    }
+
+    auto trieLookup = [&](std::string& key) { return benchTrie.findFull(key) != nullptr; };
+    average = timeMisses(trieMisses, trieLookup, found);
+    std::cout << "  Trie misses, no filter:    " << average << " ns per lookup (" << found << " found)" << std::endl;
+    benchTrie.setBloomFilter(bitsPerKey);
+    average = timeMisses(trieMisses, trieLookup, found);
+    std::cout << "  Trie misses, filtered:     " << average << " ns per lookup (" << found << " found, "
+              << benchTrie.filterRejects() << " of " << trieMisses.size() << " rejected by the filter)" << std::endl;
+}
+
+//Compares answering repeated prefix searches from the Trie each time with serving them from a bounded result cache
+void prefixCacheBenchmark(std::vector<CountyData>& dataset)
+{
+    const size_t queryCount = 200000;
+    const size_t cacheCapacity = 512;
+
+    std::cout << "\nPrefix cache benchmark (" << queryCount << " queries, " << cacheCapacity << " cached results)" << std::endl;
+    Trie benchTrie;
+    for (auto& row : dataset)
+    {
+        benchTrie.insert(row.countyName, row.stateName, row.population);
+    }
+
+    //most queries repeat the prefixes of a few popular counties, the rest are spread over the whole dataset
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> popular(0, std::min<size_t>(100, dataset.size()) - 1);
+    std::uniform_int_distribution<size_t> any(0, dataset.size() - 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<size_t> length(1, 4);
+    std::vector<std::string> queries;
+    queries.reserve(queryCount);
+    for (size_t i = 0; i < queryCount; i++)
+    {
+        const std::string& name = dataset[percent(rng) < 80 ? popular(rng) : any(rng)].countyName;
+        queries.push_back(name.substr(0, length(rng)));
+    }
+
+    size_t matches = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (auto& query : queries)
+    {
+        matches += benchTrie.searchPrefix(query).size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "  Trie only:  " << duration.count() << " ms (" << matches << " matches)" << std::endl;
+
+    BoundedHashMap<std::string, std::vector<std::string>> cache(cacheCapacity);
+    std::vector<std::string> results;
+    matches = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (auto& query : queries)
+    {
+        if (!cache.search(query, results))
+        {
+            results = benchTrie.searchPrefix(query);
+            cache.insert(query, results);
+        }
+        matches += results.size();
+    }
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "  With cache: " << duration.count() << " ms (" << matches << " matches)" << std::endl;
+    cache.printStats();
+}
+
+//Compares the Trie with the double-array FrozenTrie compiled from it, then saves the frozen image and maps it back in
+void trieFreezeBenchmark(std::vector<CountyData>& dataset)
+{
+    const std::string imagePath = "trie_image.bin";
+
+    std::cout << "\nFrozen trie benchmark (" << dataset.size() << " counties)" << std::endl;
+    Trie benchTrie;
+    std::vector<std::string> names;
+    for (auto& row : dataset)
+    {
+        benchTrie.insert(row.countyName, row.stateName, row.population);
+        names.push_back(row.countyName);
+    }
+    std::mt19937 rng(42);
+    std::shuffle(names.begin(), names.end(), rng);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    FrozenTrie frozenTrie = benchTrie.freeze();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration_freeze = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "  freeze():              " << duration_freeze.count() << " us" << std::endl;
+
+    size_t found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (auto& name : names)
+    {
+        found += !benchTrie.searchFull(name).empty();
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    std::cout << "  Trie searchFull:       " << (double)duration.count() / names.size() << " ns per lookup (" << found << " found)" << std::endl;
+
+    found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (auto& name : names)
+    {
+        found += benchTrie.findFull(name) != nullptr;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    std::cout << "  Trie findFull:         " << (double)duration.count() / names.size() << " ns per lookup (" << found << " found)" << std::endl;
+
+    found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (auto& name : names)
+    {
+        found += !frozenTrie.searchFull(name).empty();
+    }
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    std::cout << "  FrozenTrie searchFull: " << (double)duration.count() / names.size() << " ns per lookup (" << found << " found)" << std::endl;
+
+    //the frozen trie can also hand out views of its pairs, skipping the copy into a map
+    std::vector<std::pair<std::string_view, std::string_view>> statePopulations;
+    found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (auto& name : names)
+    {
+        found += frozenTrie.findFull(name, statePopulations);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    std::cout << "  FrozenTrie findFull:   " << (double)duration.count() / names.size() << " ns per lookup (" << found << " found)" << std::endl;
+
+    //every county's first two letters as a prefix, checking both tries give the same answers
+    size_t mismatches = 0;
+    for (auto& name : names)
+    {
+        std::string prefix = name.substr(0, 2);
+        mismatches += benchTrie.searchFull(name) != frozenTrie.searchFull(name);
+        mismatches += benchTrie.searchPrefix(prefix) != frozenTrie.searchPrefix(prefix);
+    }
+    std::cout << "  Mismatched results:    " << mismatches << std::endl;
+
+    frozenTrie.save(imagePath);
+    {
+        start = std::chrono::high_resolution_clock::now();
+        FrozenTrie mappedTrie = FrozenTrie::mapFile(imagePath);
+        end = std::chrono::high_resolution_clock::now();
+        auto duration_map = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        std::cout << "  mapFile():             " << duration_map.count() << " us" << std::endl;
+
+        found = 0;
+        start = std::chrono::high_resolution_clock::now();
+        for (auto& name : names)
+        {
+            found += mappedTrie.findFull(name, statePopulations);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+        std::cout << "  mapped findFull:       " << (double)duration.count() / names.size() << " ns per lookup (" << found << " found)" << std::endl;
+    }
+    std::remove(imagePath.c_str());
+
+    frozenTrie.printStats();
+}
+
+//Compares answering "k most populous matches" with topK against collecting every match and sorting them
+void trieTopKBenchmark(std::vector<CountyData>& dataset)
+{
+    const size_t k = 10;
+    const int rounds = 100;
+
+    std::cout << "\nTop-k prefix benchmark (k = " << k << ", one-letter prefixes)" << std::endl;
+    Trie benchTrie;
+    for (auto& row : dataset)
+    {
+        benchTrie.insert(row.countyName, row.stateName, row.population);
+    }
+    std::vector<std::string> prefixes;
+    for (char letter = 'A'; letter <= 'Z'; letter++)
+    {
+        prefixes.push_back(std::string(1, letter));
+    }
+
+    size_t returned = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int round = 0; round < rounds; round++)
+    {
+        for (auto& prefix : prefixes)
+        {
+            returned += benchTrie.topK(prefix, k).size();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    std::cout << "  topK:                " << (double)duration.count() / (rounds * prefixes.size()) / 1000 << " us per query (" << returned << " results)" << std::endl;
+
+    returned = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (int round = 0; round < rounds; round++)
+    {
+        for (auto& prefix : prefixes)
+        {
+            std::vector<std::pair<long long, std::string>> ranked;
+            for (auto& county : benchTrie.searchPrefix(prefix))
+            {
+                for (auto& statePopulation : *benchTrie.findFull(county))
+                {
+                    ranked.emplace_back(std::atoll(statePopulation.second.c_str()), county);
+                }
+            }
+            size_t kept = std::min(k, ranked.size());
+            std::partial_sort(ranked.begin(), ranked.begin() + kept, ranked.end(), std::greater<>());
+            returned += kept;
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    std::cout << "  searchPrefix + sort: " << (double)duration.count() / (rounds * prefixes.size()) / 1000 << " us per query (" << returned << " results)" << std::endl;
+}
+
+//Compares materializing every prefix match with streaming them through forEachWithPrefix and paging through them
+void triePrefixStreamBenchmark(std::vector<CountyData>& dataset)
+{
+    const size_t trieSize = 200000;
+    const size_t pageSize = 100;
+    const std::string prefix = "S";
+
+    std::cout << "\nPrefix streaming benchmark (" << trieSize << " words, prefix \"" << prefix << "\")" << std::endl;
+    std::vector<std::string> keys = makeBenchmarkKeys(dataset, trieSize);
+    Trie benchTrie;
+    for (auto& key : keys)
+    {
+        benchTrie.insert(key, "", "");
+    }
+
+    std::string query = prefix;
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t matches = benchTrie.searchPrefix(query).size();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "  searchPrefix, all matches:      " << duration.count() << " us (" << matches << " matches)" << std::endl;
+
+    //counting the matches only reads the count cached on the prefix's node
+    const int countRounds = 100000;
+    matches = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (int round = 0; round < countRounds; round++)
+    {
+        matches += benchTrie.countPrefix(prefix);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto duration_count = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    std::cout << "  countPrefix:                    " << (double)duration_count.count() / countRounds << " ns (" << matches / countRounds << " matches)" << std::endl;
+
+    matches = 0;
+    start = std::chrono::high_resolution_clock::now();
+    benchTrie.forEachWithPrefix(prefix, [&](std::string_view, const std::unordered_map<std::string, std::string>&)
+    {
+        matches++;
+        return true;
+    });
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "  forEachWithPrefix, all matches: " << duration.count() << " us (" << matches << " matches)" << std::endl;
+
+    matches = 0;
+    start = std::chrono::high_resolution_clock::now();
+    benchTrie.forEachWithPrefix(prefix, [&](std::string_view, const std::unordered_map<std::string, std::string>&)
+    {
+        return ++matches < pageSize;
+    });
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "  forEachWithPrefix, first " << pageSize << ":   " << duration.count() << " us (" << matches << " matches)" << std::endl;
+
+    //page through every match, resuming each page after the last word of the one before
+    size_t pages = 0;
+    matches = 0;
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<std::string> page = benchTrie.searchPrefix(prefix, pageSize);
+    while (!page.empty())
+    {
+        pages++;
+        matches += page.size();
+        if (page.size() < pageSize)
+        {
+            break;
+        }
+        page = benchTrie.searchPrefix(prefix, pageSize, page.back());
+    }
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "  pages of " << pageSize << ":                   " << (double)duration.count() / std::max<size_t>(pages, 1) << " us per page (" << pages << " pages, " << matches << " matches)" << std::endl;
+}
+
+//Times searchFuzzy on misspelled county names, made by dropping one character from each real name
+void trieFuzzyBenchmark(std::vector<CountyData>& dataset)
+{
+    const size_t queryCount = 1000;
+
+    std::cout << "\nFuzzy search benchmark (" << queryCount << " misspelled county names)" << std::endl;
+    Trie benchTrie;
+    for (auto& row : dataset)
+    {
+        benchTrie.insert(row.countyName, row.stateName, row.population);
+    }
+    std::vector<std::string> names;
+    std::vector<std::string> queries;
+    for (size_t i = 0; i < dataset.size() && queries.size() < queryCount; i += std::max<size_t>(dataset.size() / queryCount, 1))
+    {
+        std::string name = dataset[i].countyName;
+        if (name.size() > 1)
+        {
+            names.push_back(name);
+            queries.push_back(name.erase(name.size() / 2, 1));
+        }
+    }
+
+    for (size_t maxEdits = 1; maxEdits <= 2; maxEdits++)
+    {
+        size_t found = 0;
+        size_t matches = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < queries.size(); i++)
+        {
+            std::vector<TrieFuzzyMatch> results = benchTrie.searchFuzzy(queries[i], maxEdits);
+            matches += results.size();
+            found += std::any_of(results.begin(), results.end(), [&](const TrieFuzzyMatch& match) { return match.word == names[i]; });
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+        std::cout << "  up to " << maxEdits << " edit(s): " << (double)duration.count() / std::max<size_t>(queries.size(), 1) / 1000
+                  << " us per query (" << matches << " matches, " << found << "/" << queries.size() << " found the intended county)" << std::endl;
+    }
+}
+
+//Loads the county names into a map using the given hasher, times repeated lookups, and prints its chain statistics
+template <typename Hasher>
+void benchmarkCountyHasher(const std::string& hasherName, std::vector<CountyData>& dataset)
+{
+    const int repetitions = 100;
+
+    HashMap<std::string, std::string, Hasher> benchMap;
+    for (auto& row : dataset)
+    {
+        benchMap.insert(row.countyName, row.stateName);
+    }
+
+    size_t found = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repetitions; i++)
+    {
+        for (auto& row : dataset)
+        {
+            found += benchMap.find(row.countyName) != nullptr;
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+
+    std::cout << "\n" << hasherName << " on county names: " << (double)duration.count() / (repetitions * dataset.size())
+              << " ns per lookup (" << found << " found)" << std::endl;
+    benchMap.printStats();
+}
+
+//Same as benchmarkCountyHasher but on a synthetic key set, also timing insertion
+template <typename Hasher>
+void benchmarkSyntheticHasher(const std::string& hasherName, std::vector<std::string>& keys)
+{
+    HashMap<std::string, uint32_t, Hasher> benchMap;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        benchMap.insert(keys[i], (uint32_t)i);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration_insert = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+    size_t found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (auto& key : keys)
+    {
+        found += benchMap.find(key) != nullptr;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto duration_search = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+
+    std::cout << "\n" << hasherName << " on " << keys.size() << " synthetic keys: insertion " << duration_insert.count()
+              << " ms, " << (double)duration_search.count() / keys.size() << " ns per lookup (" << found << " found)" << std::endl;
+    benchMap.printStats();
+}
+
+//Compares std::hash with the built-in string hashers on the dataset and on a synthetic key set
+void hashmapHashBenchmark(std::vector<CountyData>& dataset)
+{
+    const size_t keyCount = 10000000;
+
+    std::cout << "\nHash function benchmark" << std::endl;
+    benchmarkCountyHasher<std::hash<std::string>>("std::hash", dataset);
+    benchmarkCountyHasher<Fnv1aHash>("Fnv1aHash", dataset);
+    benchmarkCountyHasher<WyHash>("WyHash", dataset);
+    benchmarkCountyHasher<Xxh3Hash>("Xxh3Hash", dataset);
+
+    std::vector<std::string> keys;
+    keys.reserve(keyCount);
+    for (size_t i = 0; i < keyCount; i++)
+    {
+        keys.push_back("county" + std::to_string(i));
+    }
+    benchmarkSyntheticHasher<std::hash<std::string>>("std::hash", keys);
+    benchmarkSyntheticHasher<Fnv1aHash>("Fnv1aHash", keys);
+    benchmarkSyntheticHasher<WyHash>("WyHash", keys);
+    benchmarkSyntheticHasher<Xxh3Hash>("Xxh3Hash", keys);
+}
+
 int main() {
 
     std::vector<CountyData> dataset;
     Trie countyTrie;
-    HashMap<std::string, std::string> countyMap;
+    CountyMap countyMap;
 
     int choice = 0;
 
-    while (choice != 9)
+    while (choice != 11)
     {
         displayMenu();
-        std::cin >> choice;
+        if (!(std::cin >> choice))
+        {
+            //a closed input would fail every read from here on, so leave rather than loop
+            if (std::cin.eof())
+            {
+                break;
+            }
+            std::cin.clear();
+            choice = 0;
+        }
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 
         switch (choice)
@@ -393,10 +1335,45 @@ int main() {
             }
             case 9:
             {
-                std::cout << "Exiting..." << std::endl;
+                if (dataset.empty())
+                {
+                    std::cout << "Dataset is empty. Please load a dataset first." << std::endl;
+                }
+                else
+                {
+                    hashmapBatchBenchmark(dataset);
+                    concurrentReadBenchmark(dataset);
+                    hashmapSizingBenchmark(dataset);
+                    hashmapHashBenchmark(dataset);
+                    hashmapPoolBenchmark();
+                    hashmapFreezeBenchmark(dataset);
+                    hashmapSnapshotBenchmark(dataset);
+                    bloomFilterBenchmark(dataset);
+                }
                 break;
             }
             case 10:
+            {
+                if (dataset.empty())
+                {
+                    std::cout << "Dataset is empty. Please load a dataset first." << std::endl;
+                }
+                else
+                {
+                    prefixCacheBenchmark(dataset);
+                    trieFreezeBenchmark(dataset);
+                    trieTopKBenchmark(dataset);
+                    triePrefixStreamBenchmark(dataset);
+                    trieFuzzyBenchmark(dataset);
+                }
+                break;
+            }
+            case 11:
+            {
+                std::cout << "Exiting..." << std::endl;
+                break;
+            }
+            case 12:
             {
                 if (countyTrie.isEmpty()) {
                     std::cout << "The countyTrie is currently empty." << std::endl;
@@ -407,7 +1384,7 @@ int main() {
             }
             default:
             {
-                std::cout << "Invalid menu choice, please enter a valid number (1-9) from the menu." << std::endl;
+                std::cout << "Invalid menu choice, please enter a valid number (1-11) from the menu." << std::endl;
                 break;
             }
 
@@ -0,0 +1,245 @@
+#include "frozen_trie.h"
+#include "trie.h"
+#include "../hashmap_implementation/MappedFile.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+using namespace std;
+
+const uint32_t NO_STATE = UINT32_MAX;
+
+FrozenTrie::FrozenTrie() : FrozenTrie(Trie().freeze())
+{
+}
+
+FrozenTrie::FrozenTrie(vector<uint64_t> built) : storage(move(built)), image(reinterpret_cast<const char*>(storage.data()))
+{
+}
+
+FrozenTrie::FrozenTrie(unique_ptr<MappedFile> mapped) : file(move(mapped)), image(file->data())
+{
+}
+
+//defined here, where MappedFile is complete
+FrozenTrie::FrozenTrie(FrozenTrie&& other) noexcept = default;
+FrozenTrie& FrozenTrie::operator=(FrozenTrie&& other) noexcept = default;
+FrozenTrie::~FrozenTrie() = default;
+
+uint32_t FrozenTrie::walk(string_view prefix) const
+{
+    const FrozenTrieUnit* cells = units();
+    uint32_t state = 0;
+    for (char ch : prefix)
+    {
+        //every base leaves 256 cells after it, so next is always inside the array
+        uint32_t next = cells[state].base + static_cast<unsigned char>(ch);
+        if (cells[next].check != state)
+        {
+            return NO_STATE;
+        }
+        state = next;
+    }
+    return state;
+}
+
+const FrozenTrieWord* FrozenTrie::findWord(string_view word) const
+{
+    uint32_t state = walk(word);
+    if (state == NO_STATE || units()[state].entry == NO_STATE)
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<const FrozenTrieWord*>(image + header().words_offset) + units()[state].entry;
+}
+
+unordered_map<string, string> FrozenTrie::searchFull(string_view word) const
+{
+    unordered_map<string, string> state_populations;
+    const FrozenTrieWord* entry = findWord(word);
+    if (entry == nullptr)
+    {
+        return state_populations;
+    }
+
+    const FrozenTriePair* pairs = reinterpret_cast<const FrozenTriePair*>(image + header().pairs_offset);
+    const char* text = image + header().text_offset;
+    for (uint32_t i = entry->first_pair; i < entry->first_pair + entry->pair_count; i++)
+    {
+        state_populations.emplace(string(text + pairs[i].state_offset, pairs[i].state_length),
+                                  string(text + pairs[i].population_offset, pairs[i].population_length));
+    }
+    return state_populations;
+}
+
+bool FrozenTrie::findFull(string_view word, vector<pair<string_view, string_view>>& state_populations) const
+{
+    state_populations.clear();
+    const FrozenTrieWord* entry = findWord(word);
+    if (entry == nullptr)
+    {
+        return false;
+    }
+
+    const FrozenTriePair* pairs = reinterpret_cast<const FrozenTriePair*>(image + header().pairs_offset);
+    const char* text = image + header().text_offset;
+    for (uint32_t i = entry->first_pair; i < entry->first_pair + entry->pair_count; i++)
+    {
+        state_populations.emplace_back(string_view(text + pairs[i].state_offset, pairs[i].state_length),
+                                       string_view(text + pairs[i].population_offset, pairs[i].population_length));
+    }
+    return true;
+}
+
+//adds every word at or below state to results in byte order, as Trie::findEntries does
+void FrozenTrie::collectWords(uint32_t state, string& prefix, vector<string>& results) const
+{
+    const FrozenTrieUnit* cells = units();
+    if (cells[state].entry != NO_STATE)
+    {
+        results.push_back(prefix);
+    }
+    for (unsigned code = cells[state].child; code != 0; )
+    {
+        uint32_t next = cells[state].base + code - 1;
+        prefix.push_back(static_cast<char>(code - 1));
+        collectWords(next, prefix, results);
+        prefix.pop_back();
+        code = cells[next].sibling;
+    }
+}
+
+vector<string> FrozenTrie::searchPrefix(string_view prefix) const
+{
+    vector<string> results;
+    uint32_t state = walk(prefix);
+    if (state != NO_STATE)
+    {
+        string path(prefix);
+        collectWords(state, path, results);
+    }
+    return results;
+}
+
+size_t FrozenTrie::size() const
+{
+    return header().word_count;
+}
+
+void FrozenTrie::save(const string& path) const
+{
+    //written beside path and renamed over it, so a process that has the old image mapped keeps reading it
+    replaceMappedFile(path, [this](ofstream& out)
+    {
+        out.write(image, static_cast<streamsize>(header().image_size));
+    });
+}
+
+//whether the size bytes at image hold sections and cells that lookups can follow without leaving them: every
+//base leaves 256 cells, every entry names a word, every word's pairs and every pair's text lie in their
+//sections, and the child and sibling codes name cells that really are children, in increasing order, so
+//collectWords visits each state once. Sizes are compared by division so hostile counts cannot wrap around.
+static bool validImage(const char* image, size_t size)
+{
+    const FrozenTrieHeader& found = *reinterpret_cast<const FrozenTrieHeader*>(image);
+    if (found.image_size != size || found.unit_count < 256 || found.unit_count > NO_STATE || found.word_count > NO_STATE ||
+        found.units_offset < sizeof(FrozenTrieHeader) || found.units_offset > found.words_offset ||
+        found.words_offset > found.pairs_offset || found.pairs_offset > found.text_offset || found.text_offset > size ||
+        found.units_offset % alignof(FrozenTrieUnit) != 0 || found.words_offset % alignof(FrozenTrieWord) != 0 ||
+        found.pairs_offset % alignof(FrozenTriePair) != 0 ||
+        found.unit_count > (found.words_offset - found.units_offset) / sizeof(FrozenTrieUnit) ||
+        found.word_count > (found.pairs_offset - found.words_offset) / sizeof(FrozenTrieWord) ||
+        found.pair_count > (found.text_offset - found.pairs_offset) / sizeof(FrozenTriePair))
+    {
+        return false;
+    }
+
+    const FrozenTrieUnit* cells = reinterpret_cast<const FrozenTrieUnit*>(image + found.units_offset);
+    //the root is nobody's child, which with one parent per cell rules out cycles
+    if (cells[0].check != NO_STATE)
+    {
+        return false;
+    }
+    for (uint64_t state = 0; state < found.unit_count; state++)
+    {
+        const FrozenTrieUnit& cell = cells[state];
+        if (uint64_t(cell.base) + 256 > found.unit_count || cell.child > 256 || cell.sibling > 256 ||
+            (cell.entry != NO_STATE && cell.entry >= found.word_count))
+        {
+            return false;
+        }
+        if (cell.child != 0 && cells[cell.base + cell.child - 1].check != state)
+        {
+            return false;
+        }
+        if (cell.check != NO_STATE)
+        {
+            if (cell.check >= found.unit_count || state < cells[cell.check].base || state - cells[cell.check].base >= 256)
+            {
+                return false;
+            }
+            uint64_t code = state - cells[cell.check].base;
+            if (cell.sibling != 0 && (cell.sibling - 1u <= code || cells[cells[cell.check].base + cell.sibling - 1].check != cell.check))
+            {
+                return false;
+            }
+        }
+        else if (cell.sibling != 0)
+        {
+            return false;
+        }
+    }
+
+    const FrozenTrieWord* words = reinterpret_cast<const FrozenTrieWord*>(image + found.words_offset);
+    for (uint64_t i = 0; i < found.word_count; i++)
+    {
+        if (uint64_t(words[i].first_pair) + words[i].pair_count > found.pair_count)
+        {
+            return false;
+        }
+    }
+    const FrozenTriePair* pairs = reinterpret_cast<const FrozenTriePair*>(image + found.pairs_offset);
+    uint64_t text_size = size - found.text_offset;
+    for (uint64_t i = 0; i < found.pair_count; i++)
+    {
+        if (uint64_t(pairs[i].state_offset) + pairs[i].state_length > text_size ||
+            uint64_t(pairs[i].population_offset) + pairs[i].population_length > text_size)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+FrozenTrie FrozenTrie::mapFile(const string& path)
+{
+    unique_ptr<MappedFile> mapped = make_unique<MappedFile>(path);
+    const FrozenTrieHeader* found = reinterpret_cast<const FrozenTrieHeader*>(mapped->data());
+    if (mapped->size() < sizeof(FrozenTrieHeader) || memcmp(found->magic, FROZEN_TRIE_MAGIC, sizeof(found->magic)) != 0 ||
+        found->version != FROZEN_TRIE_VERSION || found->unit_size != sizeof(FrozenTrieUnit))
+    {
+        throw runtime_error(path + " is not a compatible FrozenTrie image.");
+    }
+    if (!validImage(mapped->data(), mapped->size()))
+    {
+        throw runtime_error(path + " is truncated or corrupt.");
+    }
+    return FrozenTrie(move(mapped));
+}
+
+void FrozenTrie::printStats() const
+{
+    const FrozenTrieUnit* cells = units();
+    size_t states = 1;
+    for (size_t i = 0; i < header().unit_count; i++)
+    {
+        states += cells[i].check != NO_STATE;
+    }
+
+    cout << "FrozenTrie Statistics:" << endl;
+    cout << "  Number of Words: " << header().word_count << endl;
+    cout << "  Number of States: " << states << endl;
+    cout << "  Number of Cells: " << header().unit_count << endl;
+    cout << "  Cell Usage: " << (double)states / header().unit_count << endl;
+    cout << "  Image Bytes: " << header().image_size << endl;
+}
@@ -0,0 +1,128 @@
+#ifndef FROZEN_TRIE_H
+#define FROZEN_TRIE_H
+
+#include<cstdint>
+#include<memory>
+#include<string>
+#include<string_view>
+#include<unordered_map>
+#include<utility>
+#include<vector>
+using namespace std;
+
+//defined in MappedFile.h, which only frozen_trie.cpp needs; keeps the platform mapping headers out of this one
+class MappedFile;
+
+const char FROZEN_TRIE_MAGIC[8] = {'T', 'R', 'I', 'E', 'D', 'A', 'T', '\0'};
+const uint32_t FROZEN_TRIE_VERSION = 1;
+
+//the image written by FrozenTrie::save starts with this header; every section is found by its offset from
+//the start of the image, so the image is position independent and can be used straight from a mapped file.
+//The layout is native-endian, so a change to any of these structs needs a new FROZEN_TRIE_VERSION.
+struct FrozenTrieHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t unit_size;
+    uint64_t unit_count;
+    uint64_t word_count;
+    uint64_t pair_count;
+    uint64_t units_offset;
+    uint64_t words_offset;
+    uint64_t pairs_offset;
+    uint64_t text_offset;
+    uint64_t image_size;
+};
+
+//one cell of the double array. The transition from state s on byte c goes to t = base[s] + c, and is real
+//only if check[t] == s, so a step is two reads from neighbouring cells. child and sibling hold the byte + 1
+//of a state's first child and of its next sibling (0 for none), so prefix walks can list children in byte
+//order without probing all 256 cells.
+struct FrozenTrieUnit
+{
+    uint32_t base;
+    uint32_t check;
+    //index into the word table, or UINT32_MAX if no word ends here
+    uint32_t entry;
+    uint16_t child;
+    uint16_t sibling;
+};
+
+//the state -> population pairs of one word
+struct FrozenTrieWord
+{
+    uint32_t first_pair;
+    uint32_t pair_count;
+};
+
+//offsets are from the start of the text section
+struct FrozenTriePair
+{
+    uint32_t state_offset;
+    uint32_t state_length;
+    uint32_t population_offset;
+    uint32_t population_length;
+};
+
+//read-only copy of a Trie, built by Trie::freeze(), compiled into a double-array trie: the states of the
+//trie, one per character, are cells of a single array, so following a character is arithmetic plus one
+//bounds-free array lookup instead of a search through a node's children. The whole structure is one
+//contiguous image, which save() writes out as is and mapFile() maps back in, checking it but copying nothing.
+class FrozenTrie
+{
+public:
+    //an empty trie
+    FrozenTrie();
+
+    FrozenTrie(const FrozenTrie&) = delete;
+    FrozenTrie& operator=(const FrozenTrie&) = delete;
+    //moving keeps the image where it is, so image stays valid
+    FrozenTrie(FrozenTrie&& other) noexcept;
+    FrozenTrie& operator=(FrozenTrie&& other) noexcept;
+    ~FrozenTrie();
+
+    //same results as Trie::searchFull and Trie::searchPrefix on the trie it was frozen from
+    unordered_map<string, string> searchFull(string_view word) const;
+    vector<string> searchPrefix(string_view prefix) const;
+    //fills state_populations with views of word's pairs in the image, valid while this FrozenTrie lives, without
+    //building a map; returns false if word is missing
+    bool findFull(string_view word, vector<pair<string_view, string_view>>& state_populations) const;
+
+    size_t size() const;
+    //writes the image to path, replacing any existing file without disturbing processes that have it mapped
+    void save(const string& path) const;
+    //opens an image written by save(), checking every section once so that corrupt files are rejected here
+    //rather than read out of bounds later; lookups then read the mapped pages directly
+    static FrozenTrie mapFile(const string& path);
+    void printStats() const;
+
+private:
+    friend class Trie;
+
+    //backing store for an image built in memory; uint64_t keeps every section aligned
+    vector<uint64_t> storage;
+    //set only for a trie opened by mapFile
+    unique_ptr<MappedFile> file;
+    const char* image;
+
+    //takes ownership of an image built by Trie::freeze
+    explicit FrozenTrie(vector<uint64_t> built);
+    //reads an image mapFile has already checked straight from the mapping
+    explicit FrozenTrie(unique_ptr<MappedFile> mapped);
+
+    const FrozenTrieHeader& header() const
+    {
+        return *reinterpret_cast<const FrozenTrieHeader*>(image);
+    }
+    const FrozenTrieUnit* units() const
+    {
+        return reinterpret_cast<const FrozenTrieUnit*>(image + header().units_offset);
+    }
+    //state reached by following prefix from the root, or UINT32_MAX if there is none
+    uint32_t walk(string_view prefix) const;
+    //word's entry in the word table, or nullptr if word is missing
+    const FrozenTrieWord* findWord(string_view word) const;
+    void collectWords(uint32_t state, string& prefix, vector<string>& results) const;
+};
+
+#endif //FROZEN_TRIE_H
@@ -1,76 +1,1263 @@
 #include "trie.h"
 #include <iostream>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRIE_USE_SSE2 1
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 using namespace std;
 
+//position of the lowest set bit of a non-zero mask
+static unsigned lowestBit(unsigned mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+//position of ch in the first count sorted keys, or count if it is not there
+static size_t findKey(const unsigned char* keys, size_t count, unsigned char ch)
+{
+    size_t i = 0;
+    while (i < count && keys[i] != ch)
+    {
+        i++;
+    }
+    return i;
+}
+
+//first position in the first count sorted keys whose key is greater than ch
+static size_t insertPosition(const unsigned char* keys, size_t count, unsigned char ch)
+{
+    size_t i = 0;
+    while (i < count && keys[i] < ch)
+    {
+        i++;
+    }
+    return i;
+}
+
+TrieArena::TrieArena() : used_nodes(0), live_label_bytes(0) {}
+
+uint32_t TrieArena::newNode()
+{
+    uint32_t index;
+    if (!free_nodes.empty())
+    {
+        index = free_nodes.back();
+        free_nodes.pop_back();
+    }
+    else
+    {
+        if (used_nodes == chunks.size() * CHUNK_SIZE)
+        {
+            if (chunks.size() == (NO_INDEX >> CHUNK_BITS))
+            {
+                throw length_error("Trie supports fewer than 2^32 nodes.");
+            }
+            chunks.push_back(unique_ptr<TrieNode[]>(new TrieNode[CHUNK_SIZE]));
+        }
+        index = used_nodes++;
+    }
+
+    TrieNode& fresh = node(index);
+    fresh.children.kind = TrieChildren::NODE4;
+    fresh.children.count = 0;
+    fresh.label_offset = 0;
+    fresh.label_length = 0;
+    fresh.entry = NO_INDEX;
+    fresh.subtree_words = 0;
+    fresh.max_population = NO_POPULATION;
+    return index;
+}
+
+void TrieArena::freeNode(uint32_t index)
+{
+    TrieNode& freed = node(index);
+    freeLayout(freed.children);
+    //a free node owns no label bytes, which is how compactLabels tells it apart from a live one
+    live_label_bytes -= freed.label_length;
+    freed.label_offset = 0;
+    freed.label_length = 0;
+    free_nodes.push_back(index);
+}
+
+void TrieArena::setLabel(TrieNode& current, string_view text)
+{
+    //labels are never edited in place, so replacing and removing words leaves dead bytes behind; once they
+    //outnumber the live ones, copying the live ones out costs no more than the churn that left them
+    size_t dead_label_bytes = labels.size() - live_label_bytes;
+    if (dead_label_bytes > live_label_bytes || (dead_label_bytes > 0 && labels.size() + text.size() > NO_INDEX))
+    {
+        compactLabels();
+    }
+    if (labels.size() + text.size() > NO_INDEX)
+    {
+        throw length_error("Trie labels must total less than 4 GiB.");
+    }
+    live_label_bytes -= current.label_length;
+    live_label_bytes += text.size();
+    current.label_offset = static_cast<uint32_t>(labels.size());
+    current.label_length = static_cast<uint32_t>(text.size());
+    labels.insert(labels.end(), text.begin(), text.end());
+}
+
+void TrieArena::compactLabels()
+{
+    //labels never overlap, so copying them in offset order keeps the ones that sit side by side (the two
+    //halves of a split edge) side by side, which is what lets Trie::mergeWithChild join them in place
+    vector<uint32_t> owners;
+    for (uint32_t index = 0; index < used_nodes; index++)
+    {
+        if (node(index).label_length != 0)
+        {
+            owners.push_back(index);
+        }
+    }
+    sort(owners.begin(), owners.end(), [this](uint32_t a, uint32_t b)
+    {
+        return node(a).label_offset < node(b).label_offset;
+    });
+
+    vector<char> compacted;
+    compacted.reserve(live_label_bytes);
+    for (uint32_t index : owners)
+    {
+        TrieNode& owner = node(index);
+        uint32_t offset = static_cast<uint32_t>(compacted.size());
+        compacted.insert(compacted.end(), labels.begin() + owner.label_offset,
+                         labels.begin() + owner.label_offset + owner.label_length);
+        owner.label_offset = offset;
+    }
+    labels.swap(compacted);
+}
+
+uint32_t TrieArena::newLayout(TrieChildren::Kind kind)
+{
+    vector<uint32_t>& free_slots = free_layouts[kind];
+    uint32_t slot;
+    if (!free_slots.empty())
+    {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    }
+    else if (kind == TrieChildren::NODE16)
+    {
+        slot = static_cast<uint32_t>(node16s.size());
+        node16s.emplace_back();
+    }
+    else if (kind == TrieChildren::NODE48)
+    {
+        slot = static_cast<uint32_t>(node48s.size());
+        node48s.emplace_back();
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(node256s.size());
+        node256s.emplace_back();
+    }
+
+    if (kind == TrieChildren::NODE48)
+    {
+        memset(node48s[slot].index, 0, sizeof(node48s[slot].index));
+        fill(begin(node48s[slot].children), end(node48s[slot].children), NO_INDEX);
+    }
+    else if (kind == TrieChildren::NODE256)
+    {
+        fill(begin(node256s[slot].children), end(node256s[slot].children), NO_INDEX);
+    }
+    return slot;
+}
+
+void TrieArena::freeLayout(const TrieChildren& children)
+{
+    if (children.kind != TrieChildren::NODE4)
+    {
+        free_layouts[children.kind].push_back(children.layout);
+    }
+}
+
+uint32_t TrieArena::findChild(const TrieNode& current, char ch) const
+{
+    const TrieChildren& children = current.children;
+    unsigned char key = static_cast<unsigned char>(ch);
+    switch (children.kind)
+    {
+        case TrieChildren::NODE4:
+        {
+            size_t i = findKey(children.small.keys, children.count, key);
+            return i < children.count ? children.small.children[i] : NO_INDEX;
+        }
+        case TrieChildren::NODE16:
+        {
+            const Node16& layout = node16s[children.layout];
+#ifdef TRIE_USE_SSE2
+            //compare the key against all 16 slots at once, ignoring the unused ones
+            __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(key)),
+                                             _mm_loadu_si128(reinterpret_cast<const __m128i*>(layout.keys)));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(matches)) & ((1u << children.count) - 1);
+            return mask != 0 ? layout.children[lowestBit(mask)] : NO_INDEX;
+#else
+            size_t i = findKey(layout.keys, children.count, key);
+            return i < children.count ? layout.children[i] : NO_INDEX;
+#endif
+        }
+        case TrieChildren::NODE48:
+        {
+            const Node48& layout = node48s[children.layout];
+            return layout.index[key] != 0 ? layout.children[layout.index[key] - 1] : NO_INDEX;
+        }
+        case TrieChildren::NODE256:
+            return node256s[children.layout].children[key];
+    }
+    return NO_INDEX;
+}
+
+void TrieArena::replaceChild(TrieNode& current, char ch, uint32_t child)
+{
+    TrieChildren& children = current.children;
+    unsigned char key = static_cast<unsigned char>(ch);
+    switch (children.kind)
+    {
+        case TrieChildren::NODE4:
+            children.small.children[findKey(children.small.keys, children.count, key)] = child;
+            break;
+        case TrieChildren::NODE16:
+        {
+            Node16& layout = node16s[children.layout];
+            layout.children[findKey(layout.keys, children.count, key)] = child;
+            break;
+        }
+        case TrieChildren::NODE48:
+        {
+            Node48& layout = node48s[children.layout];
+            layout.children[layout.index[key] - 1] = child;
+            break;
+        }
+        case TrieChildren::NODE256:
+            node256s[children.layout].children[key] = child;
+            break;
+    }
+}
+
+void TrieArena::insertChild(TrieNode& current, char ch, uint32_t child)
+{
+    TrieChildren& children = current.children;
+    if ((children.kind == TrieChildren::NODE4 && children.count == 4) ||
+        (children.kind == TrieChildren::NODE16 && children.count == 16) ||
+        (children.kind == TrieChildren::NODE48 && children.count == 48))
+    {
+        convert(current, static_cast<TrieChildren::Kind>(children.kind + 1));
+    }
+
+    unsigned char key = static_cast<unsigned char>(ch);
+    switch (children.kind)
+    {
+        case TrieChildren::NODE4:
+        case TrieChildren::NODE16:
+        {
+            bool inline_keys = children.kind == TrieChildren::NODE4;
+            unsigned char* keys = inline_keys ? children.small.keys : node16s[children.layout].keys;
+            uint32_t* slots = inline_keys ? children.small.children : node16s[children.layout].children;
+            size_t position = insertPosition(keys, children.count, key);
+            memmove(keys + position + 1, keys + position, children.count - position);
+            memmove(slots + position + 1, slots + position, (children.count - position) * sizeof(uint32_t));
+            keys[position] = key;
+            slots[position] = child;
+            break;
+        }
+        case TrieChildren::NODE48:
+        {
+            //slots freed by erase leave holes, so take the first empty one
+            Node48& layout = node48s[children.layout];
+            size_t slot = 0;
+            while (layout.children[slot] != NO_INDEX)
+            {
+                slot++;
+            }
+            layout.children[slot] = child;
+            layout.index[key] = static_cast<unsigned char>(slot + 1);
+            break;
+        }
+        case TrieChildren::NODE256:
+            node256s[children.layout].children[key] = child;
+            break;
+    }
+    children.count++;
+}
+
+uint32_t TrieArena::eraseChild(TrieNode& current, char ch)
+{
+    TrieChildren& children = current.children;
+    unsigned char key = static_cast<unsigned char>(ch);
+    uint32_t removed = NO_INDEX;
+    switch (children.kind)
+    {
+        case TrieChildren::NODE4:
+        case TrieChildren::NODE16:
+        {
+            bool inline_keys = children.kind == TrieChildren::NODE4;
+            unsigned char* keys = inline_keys ? children.small.keys : node16s[children.layout].keys;
+            uint32_t* slots = inline_keys ? children.small.children : node16s[children.layout].children;
+            size_t position = findKey(keys, children.count, key);
+            if (position == children.count)
+            {
+                return NO_INDEX;
+            }
+            removed = slots[position];
+            memmove(keys + position, keys + position + 1, children.count - position - 1);
+            memmove(slots + position, slots + position + 1, (children.count - position - 1) * sizeof(uint32_t));
+            break;
+        }
+        case TrieChildren::NODE48:
+        {
+            Node48& layout = node48s[children.layout];
+            if (layout.index[key] == 0)
+            {
+                return NO_INDEX;
+            }
+            removed = layout.children[layout.index[key] - 1];
+            layout.children[layout.index[key] - 1] = NO_INDEX;
+            layout.index[key] = 0;
+            break;
+        }
+        case TrieChildren::NODE256:
+        {
+            Node256& layout = node256s[children.layout];
+            removed = layout.children[key];
+            if (removed == NO_INDEX)
+            {
+                return NO_INDEX;
+            }
+            layout.children[key] = NO_INDEX;
+            break;
+        }
+    }
+    children.count--;
+
+    //shrink well below each layout's capacity so a node hovering at a boundary does not convert back and forth
+    if ((children.kind == TrieChildren::NODE16 && children.count <= 3) ||
+        (children.kind == TrieChildren::NODE48 && children.count <= 12) ||
+        (children.kind == TrieChildren::NODE256 && children.count <= 36))
+    {
+        convert(current, static_cast<TrieChildren::Kind>(children.kind - 1));
+    }
+    return removed;
+}
+
+void TrieArena::convert(TrieNode& current, TrieChildren::Kind target)
+{
+    unsigned char keys[256];
+    uint32_t slots[256];
+    size_t total = 0;
+    forEachChild(current, [&](char ch, uint32_t child)
+    {
+        keys[total] = static_cast<unsigned char>(ch);
+        slots[total] = child;
+        total++;
+    });
+
+    TrieChildren& children = current.children;
+    freeLayout(children);
+    children.kind = target;
+    if (target == TrieChildren::NODE4)
+    {
+        memcpy(children.small.keys, keys, total);
+        memcpy(children.small.children, slots, total * sizeof(uint32_t));
+        return;
+    }
+
+    children.layout = newLayout(target);
+    switch (target)
+    {
+        case TrieChildren::NODE16:
+            memcpy(node16s[children.layout].keys, keys, total);
+            memcpy(node16s[children.layout].children, slots, total * sizeof(uint32_t));
+            break;
+        case TrieChildren::NODE48:
+            for (size_t i = 0; i < total; i++)
+            {
+                node48s[children.layout].index[keys[i]] = static_cast<unsigned char>(i + 1);
+                node48s[children.layout].children[i] = slots[i];
+            }
+            break;
+        case TrieChildren::NODE256:
+            for (size_t i = 0; i < total; i++)
+            {
+                node256s[children.layout].children[keys[i]] = slots[i];
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+size_t TrieArena::memoryUsage() const
+{
+    return chunks.size() * CHUNK_SIZE * sizeof(TrieNode) + labels.capacity() + node16s.capacity() * sizeof(Node16) +
+           node48s.capacity() * sizeof(Node48) + node256s.capacity() * sizeof(Node256);
+}
+
+void TrieArena::clear()
+{
+    //every pool holds plain data, so this frees whole chunks without visiting nodes
+    vector<unique_ptr<TrieNode[]>>().swap(chunks);
+    vector<uint32_t>().swap(free_nodes);
+    vector<char>().swap(labels);
+    live_label_bytes = 0;
+    vector<Node16>().swap(node16s);
+    vector<Node48>().swap(node48s);
+    vector<Node256>().swap(node256s);
+    for (vector<uint32_t>& free_slots : free_layouts)
+    {
+        vector<uint32_t>().swap(free_slots);
+    }
+    used_nodes = 0;
+}
+
+//length of the longest common prefix of a and b
+static size_t commonPrefix(string_view a, string_view b)
+{
+    size_t length = 0;
+    while (length < a.size() && length < b.size() && a[length] == b[length])
+    {
+        length++;
+    }
+    return length;
+}
+
+void Trie::mergeWithChild(uint32_t parent, uint32_t node)
+{
+    TrieNode& middle = arena.node(node);
+    uint32_t child = NO_INDEX;
+    arena.forEachChild(middle, [&](char, uint32_t only) { child = only; });
+    TrieNode& last = arena.node(child);
+    char key = arena.label(middle)[0];
+
+    if (middle.label_offset + middle.label_length == last.label_offset)
+    {
+        //the two labels still sit side by side from when the edge was split, so just widen the child's;
+        //the bytes now belong to the child, so freeing middle must not count them as dead
+        last.label_offset = middle.label_offset;
+        last.label_length += middle.label_length;
+        middle.label_length = 0;
+    }
+    else
+    {
+        string joined(arena.label(middle));
+        joined.append(arena.label(last));
+        arena.setLabel(last, joined);
+    }
+    arena.replaceChild(arena.node(parent), key, child);
+    arena.freeNode(node);
+}
+
+//population as a number for ranking; anything that is not a whole number counts as 0
+static int64_t parsePopulation(string_view population)
+{
+    int64_t value = 0;
+    from_chars(population.data(), population.data() + population.size(), value);
+    return value;
+}
+
+void Trie::uncountWord(string_view word)
+{
+    uint32_t current = root;
+    size_t i = 0;
+    while (true)
+    {
+        TrieNode& node = arena.node(current);
+        node.subtree_words--;
+        i += node.label_length;
+        if (i >= word.size())
+        {
+            break;
+        }
+        current = arena.findChild(node, word[i]);
+    }
+}
+
+int64_t Trie::entryMaximum(const TrieNode& current) const
+{
+    int64_t best = NO_POPULATION;
+    if (current.entry != NO_INDEX)
+    {
+        for (const auto& state_population : entries[current.entry])
+        {
+            best = max(best, parsePopulation(state_population.second));
+        }
+    }
+    return best;
+}
+
+void Trie::refreshMaximums(string_view word)
+{
+    //the nodes whose whole label lies along word are the only ones whose subtree changed
+    vector<uint32_t> path;
+    uint32_t current = root;
+    size_t i = 0;
+    while (current != NO_INDEX)
+    {
+        string_view label = arena.label(arena.node(current));
+        if (word.compare(i, label.size(), label) != 0)
+        {
+            break;
+        }
+        path.push_back(current);
+        i += label.size();
+        current = i < word.size() ? arena.findChild(arena.node(current), word[i]) : NO_INDEX;
+    }
+
+    for (size_t j = path.size(); j-- > 0; )
+    {
+        TrieNode& node = arena.node(path[j]);
+        int64_t best = entryMaximum(node);
+        arena.forEachChild(node, [&](char, uint32_t child)
+        {
+            best = max(best, arena.node(child).max_population);
+        });
+        node.max_population = best;
+    }
+}
+
 void Trie::insert(const string& word, const string& state, const string& population)
 {
-    TrieNode* current = root;
-    for (char ch : word)
+    int64_t value = parsePopulation(population);
+    uint32_t current = root;
+    size_t i = 0;
+    while (i < word.size())
     {
-        if (current->children.find(ch) == current->children.end())
+        //the word ends below every node on its way down, so each can count it and take its population now
+        arena.node(current).subtree_words++;
+        arena.node(current).max_population = max(arena.node(current).max_population, value);
+        uint32_t next = arena.findChild(arena.node(current), word[i]);
+        if (next == NO_INDEX)
+        {
+            //no edge starts with this character, so the rest of the word becomes a single new leaf
+            next = arena.newNode();
+            arena.setLabel(arena.node(next), string_view(word).substr(i));
+            arena.insertChild(arena.node(current), word[i], next);
+            current = next;
+            break;
+        }
+
+        TrieNode& child = arena.node(next);
+        size_t shared = commonPrefix(arena.label(child), string_view(word).substr(i));
+        if (shared < child.label_length)
         {
-            current->children[ch] = new TrieNode();
+            //the word leaves this edge part way along, so split the edge there; both halves keep
+            //pointing into the original label bytes
+            uint32_t middle = arena.newNode();
+            TrieNode& split = arena.node(middle);
+            split.label_offset = child.label_offset;
+            split.label_length = static_cast<uint32_t>(shared);
+            split.subtree_words = child.subtree_words;
+            split.max_population = child.max_population;
+            child.label_offset += static_cast<uint32_t>(shared);
+            child.label_length -= static_cast<uint32_t>(shared);
+            arena.insertChild(split, arena.label(child)[0], next);
+            arena.replaceChild(arena.node(current), word[i], middle);
+            next = middle;
         }
-        current = current->children[ch];
+        current = next;
+        i += shared;
+    }
+
+    TrieNode& last = arena.node(current);
+    last.subtree_words++;
+    last.max_population = max(last.max_population, value);
+    if (last.entry != NO_INDEX)
+    {
+        //the word was already stored, so it was counted twice on the way down
+        uncountWord(word);
+    }
+    else
+    {
+        word_count++;
+        if (filter.enabled())
+        {
+            if (filter.full())
+            {
+                rebuildFilter();
+            }
+            filter.insert(hash<string_view>{}(word));
+        }
+        if (!free_entries.empty())
+        {
+            last.entry = free_entries.back();
+            free_entries.pop_back();
+        }
+        else
+        {
+            last.entry = static_cast<uint32_t>(entries.size());
+            entries.emplace_back();
+        }
+    }
+    unordered_map<string, string>& state_populations = entries[last.entry];
+    auto previous = state_populations.find(state);
+    //replacing a population with a smaller one may lower the maximums above it
+    bool lowered = previous != state_populations.end() && parsePopulation(previous->second) > value;
+    state_populations[state] = population;
+    if (lowered)
+    {
+        refreshMaximums(word);
     }
-    current->end_word = true;
-    current->state_populations[state] = population;
 }
 
 unordered_map<string, string> Trie::searchFull(string& word)
 {
-    unordered_map<string, string> result;
-    TrieNode* current = root;
-    for (char ch : word)
+    return searchFull(string_view(word));
+}
+
+unordered_map<string, string> Trie::searchFull(string_view word)
+{
+    const unordered_map<string, string>* state_populations = findFull(word);
+    if (state_populations == nullptr)
+    {
+        return unordered_map<string, string>();
+    }
+    return *state_populations;
+}
+
+unordered_map<string, string> Trie::searchFull(const char* word, size_t length)
+{
+    return searchFull(string_view(word, length));
+}
+
+const unordered_map<string, string>* Trie::findFull(string_view word) const
+{
+    if (filter.enabled() && !filter.mayContain(hash<string_view>{}(word)))
     {
-        if (current->children.find(ch) == current->children.end())
+        filter.recordRejection();
+        return nullptr;
+    }
+
+    uint32_t current = root;
+    size_t i = 0;
+    while (i < word.size())
+    {
+        current = arena.findChild(arena.node(current), word[i]);
+        if (current == NO_INDEX)
         {
             //cout << "In Search Fail" << endl;
-            return result;
+            return nullptr;
         }
-        current = current->children[ch];
+        string_view label = arena.label(arena.node(current));
+        if (word.compare(i, label.size(), label) != 0)
+        {
+            return nullptr;
+        }
+        i += label.size();
     }
 
-    if (current != nullptr && current->end_word)
+    uint32_t entry = arena.node(current).entry;
+    return entry != NO_INDEX ? &entries[entry] : nullptr;
+}
+
+uint32_t Trie::prefixNode(string_view prefix, string* path) const
+{
+    uint32_t current = root;
+    //the prefix may end part way along an edge, so spell out the whole path to the node reached
+    if (path != nullptr)
     {
-        result = current->state_populations;
-        return result;
+        path->clear();
     }
-    return result;
+    size_t i = 0;
+    while (i < prefix.size())
+    {
+        current = arena.findChild(arena.node(current), prefix[i]);
+        if (current == NO_INDEX)
+        {
+            return NO_INDEX;
+        }
+        string_view label = arena.label(arena.node(current));
+        size_t shared = commonPrefix(label, prefix.substr(i));
+        if (shared < label.size() && i + shared < prefix.size())
+        {
+            return NO_INDEX;
+        }
+        if (path != nullptr)
+        {
+            *path += label;
+        }
+        i += label.size();
+    }
+    return current;
 }
 
 vector<string> Trie::searchPrefix(string& prefix)
 {
     vector<string> results;
-    TrieNode* current = root;
-    for (char ch : prefix)
+    string path;
+    uint32_t current = prefixNode(prefix, &path);
+    if (current != NO_INDEX)
     {
-        if (current->children.find(ch) == current->children.end())
+        findEntries(&arena.node(current), path, results);
+    }
+    return results;
+}
+
+size_t Trie::countPrefix(string_view prefix) const
+{
+    uint32_t current = prefixNode(prefix, nullptr);
+    return current == NO_INDEX ? 0 : arena.node(current).subtree_words;
+}
+
+//fills row d of the edit distance table, for the first d characters of a word ending in ch, from row d - 1. Row d
+//holds the distances between those characters and each prefix of target; only cells j with |j - d| <= max_edits
+//can be within the bound, so just that band is computed. Returns the smallest distance in the band, or
+//max_edits + 1 if the band is empty.
+static uint32_t fillEditRow(vector<uint32_t>& rows, string_view target, size_t d, char ch, uint32_t max_edits)
+{
+    size_t width = target.size() + 1;
+    size_t low = d > max_edits ? d - max_edits : 0;
+    size_t high = min(target.size(), d + max_edits);
+    if (low > high)
+    {
+        return max_edits + 1;
+    }
+    size_t previous_high = min(target.size(), d - 1 + max_edits);
+    if (rows.size() < (d + 1) * width)
+    {
+        rows.resize((d + 1) * width);
+    }
+    const uint32_t* previous = rows.data() + (d - 1) * width;
+    uint32_t* row = rows.data() + d * width;
+    uint32_t best = max_edits + 1;
+    for (size_t j = low; j <= high; j++)
+    {
+        uint32_t distance;
+        if (j == 0)
         {
-            return results;
+            distance = static_cast<uint32_t>(d);
         }
-        current = current->children[ch];
+        else
+        {
+            distance = previous[j - 1] + (target[j - 1] != ch);
+            if (j <= previous_high)
+            {
+                distance = min(distance, previous[j] + 1);
+            }
+            if (j > low)
+            {
+                distance = min(distance, row[j - 1] + 1);
+            }
+        }
+        row[j] = distance;
+        best = min(best, distance);
     }
+    return best;
+}
+
+void Trie::fuzzyVisit(uint32_t current, string& word, string_view target, uint32_t max_edits, vector<uint32_t>& rows,
+                      vector<TrieFuzzyMatch>& results) const
+{
+    size_t width = target.size() + 1;
+    size_t depth = word.size();
+    const TrieNode& node = arena.node(current);
+    if (node.entry != NO_INDEX && depth + max_edits >= target.size() && target.size() + max_edits >= depth)
+    {
+        uint32_t distance = rows[depth * width + target.size()];
+        if (distance <= max_edits)
+        {
+            for (const auto& state_population : entries[node.entry])
+            {
+                results.push_back(TrieFuzzyMatch{word, state_population.first, parsePopulation(state_population.second), distance});
+            }
+        }
+    }
+    arena.forEachChild(node, [&](char ch, uint32_t child)
+    {
+        //the key is the label's first character, so most children are ruled out without reading their node
+        if (fillEditRow(rows, target, depth + 1, ch, max_edits) > max_edits)
+        {
+            return;
+        }
+        string_view label = arena.label(arena.node(child));
+        word += label;
+        for (size_t i = 1; i < label.size(); i++)
+        {
+            if (fillEditRow(rows, target, depth + 1 + i, label[i], max_edits) > max_edits)
+            {
+                //every continuation of this edge is at least that far away
+                word.resize(depth);
+                return;
+            }
+        }
+        fuzzyVisit(child, word, target, max_edits, rows, results);
+        word.resize(depth);
+    });
+}
+
+vector<TrieFuzzyMatch> Trie::searchFuzzy(string_view word, size_t max_edits) const
+{
+    vector<TrieFuzzyMatch> results;
+    uint32_t bound = static_cast<uint32_t>(min<size_t>(max_edits, UINT32_MAX - 1));
+    //row 0 compares the empty string with each prefix of word
+    vector<uint32_t> rows(word.size() + 1);
+    for (size_t j = 0; j < rows.size(); j++)
+    {
+        rows[j] = static_cast<uint32_t>(j);
+    }
+    string spelling;
+    fuzzyVisit(root, spelling, word, bound, rows, results);
+
+    sort(results.begin(), results.end(), [](const TrieFuzzyMatch& a, const TrieFuzzyMatch& b)
+    {
+        if (a.distance != b.distance)
+        {
+            return a.distance < b.distance;
+        }
+        if (a.population != b.population)
+        {
+            return a.population > b.population;
+        }
+        return a.word != b.word ? a.word < b.word : a.state < b.state;
+    });
+    return results;
+}
+
+vector<string> Trie::searchPrefix(string_view prefix, size_t limit) const
+{
+    vector<string> results;
+    if (limit > 0)
+    {
+        forEachWithPrefix(prefix, [&](string_view word, const unordered_map<string, string>&)
+        {
+            results.emplace_back(word);
+            return results.size() < limit;
+        });
+    }
+    return results;
+}
+
+vector<string> Trie::searchPrefix(string_view prefix, size_t limit, string_view after) const
+{
+    vector<string> results;
+    if (limit > 0)
+    {
+        forEachWithPrefix(prefix, after, [&](string_view word, const unordered_map<string, string>&)
+        {
+            results.emplace_back(word);
+            return results.size() < limit;
+        });
+    }
+    return results;
+}
+
+vector<TrieMatch> Trie::topK(string_view prefix, size_t k) const
+{
+    vector<TrieMatch> results;
+    string path;
+    uint32_t current = prefixNode(prefix, &path);
+    if (current == NO_INDEX || k == 0 || arena.node(current).max_population == NO_POPULATION)
+    {
+        return results;
+    }
+
+    //nodes reached so far, each with the visit it was reached from, so a word is only spelled out once it
+    //makes the results
+    struct Visit
+    {
+        uint32_t node;
+        uint32_t parent;
+    };
+    //either a node, ranked by the largest population below it, or one (word, state) pair ranked by its own
+    //population; a pair popped off the heap beats everything still on it
+    struct Candidate
+    {
+        int64_t population;
+        uint32_t visit;
+        const pair<const string, string>* state_population;
+
+        bool operator<(const Candidate& other) const
+        {
+            if (population != other.population)
+            {
+                return population < other.population;
+            }
+            return state_population == nullptr && other.state_population != nullptr;
+        }
+    };
+    vector<Visit> visits = {Visit{current, NO_INDEX}};
+    priority_queue<Candidate> candidates;
+    candidates.push(Candidate{arena.node(current).max_population, 0, nullptr});
+
+    while (!candidates.empty() && results.size() < k)
+    {
+        Candidate best = candidates.top();
+        candidates.pop();
+        if (best.state_population != nullptr)
+        {
+            //labels from the pair's node back up to the start of the search, in reverse
+            vector<string_view> labels;
+            for (uint32_t visit = best.visit; visit != 0; visit = visits[visit].parent)
+            {
+                labels.push_back(arena.label(arena.node(visits[visit].node)));
+            }
+            string word = path;
+            for (size_t j = labels.size(); j-- > 0; )
+            {
+                word += labels[j];
+            }
+            results.push_back(TrieMatch{word, best.state_population->first, best.population});
+            continue;
+        }
 
-    findEntries(current, prefix, results);
+        const TrieNode& node = arena.node(visits[best.visit].node);
+        if (node.entry != NO_INDEX)
+        {
+            for (const auto& state_population : entries[node.entry])
+            {
+                candidates.push(Candidate{parsePopulation(state_population.second), best.visit, &state_population});
+            }
+        }
+        arena.forEachChild(node, [&](char, uint32_t child)
+        {
+            visits.push_back(Visit{child, best.visit});
+            candidates.push(Candidate{arena.node(child).max_population, static_cast<uint32_t>(visits.size() - 1), nullptr});
+        });
+    }
     return results;
 }
 
 void Trie::findEntries(TrieNode* current, string& prefix, vector<string>& results)
 {
-    if (current->end_word)
+    if (current->entry != NO_INDEX)
     {
         results.push_back(prefix);
     }
-    for (auto& [key, value] : current->children)
+    arena.forEachChild(*current, [&](char, uint32_t child)
+    {
+        TrieNode& value = arena.node(child);
+        size_t length = prefix.size();
+        prefix += arena.label(value);
+        findEntries(&value, prefix, results);
+        prefix.resize(length);
+    });
+}
+
+bool Trie::remove(string_view word)
+{
+    //remember the path so the nodes around the removed word can be pruned or merged
+    vector<uint32_t> path;
+    uint32_t current = root;
+    path.push_back(current);
+    size_t i = 0;
+    while (i < word.size())
+    {
+        current = arena.findChild(arena.node(current), word[i]);
+        if (current == NO_INDEX)
+        {
+            return false;
+        }
+        string_view label = arena.label(arena.node(current));
+        if (word.compare(i, label.size(), label) != 0)
+        {
+            return false;
+        }
+        path.push_back(current);
+        i += label.size();
+    }
+    TrieNode& target = arena.node(current);
+    if (target.entry == NO_INDEX)
+    {
+        return false;
+    }
+
+    for (uint32_t node : path)
+    {
+        arena.node(node).subtree_words--;
+    }
+    entries[target.entry].clear();
+    free_entries.push_back(target.entry);
+    target.entry = NO_INDEX;
+    word_count--;
+    if (current == root)
     {
-        prefix.push_back(key);
-        findEntries(value, prefix, results);
-        prefix.pop_back();
+        refreshMaximums(word);
+        return true;
+    }
+
+    //keep the trie compressed: a leaf that ends no word goes, and a node left with one child and no word
+    //is merged into that child
+    uint32_t parent = path[path.size() - 2];
+    TrieNode& above = arena.node(parent);
+    if (target.children.count == 0)
+    {
+        arena.freeNode(arena.eraseChild(above, arena.label(target)[0]));
+        if (parent != root && above.entry == NO_INDEX && above.children.count == 1)
+        {
+            mergeWithChild(path[path.size() - 3], parent);
+        }
+    }
+    else if (target.children.count == 1)
+    {
+        mergeWithChild(parent, current);
+    }
+    refreshMaximums(word);
+    return true;
+}
+
+void Trie::clear()
+{
+    arena.clear();
+    deque<unordered_map<string, string>>().swap(entries);
+    vector<uint32_t>().swap(free_entries);
+    word_count = 0;
+    root = arena.newNode();
+    if (filter.enabled())
+    {
+        rebuildFilter();
     }
 }
 
 bool Trie::isEmpty()
 {
-    return root->children.empty();
-}
\ No newline at end of file
+    return arena.node(root).children.count == 0;
+}
+
+void Trie::setBloomFilter(size_t bits_per_key)
+{
+    filter = BlockedBloomFilter(bits_per_key, 0);
+    if (filter.enabled())
+    {
+        rebuildFilter();
+    }
+}
+
+size_t Trie::filterRejects() const
+{
+    return filter.rejectedQueries();
+}
+
+FrozenTrie Trie::freeze() const
+{
+    //a state of the double array is a position within a node's label: depth bytes of it have been read
+    struct Pending
+    {
+        uint32_t cell;
+        uint32_t node;
+        uint32_t depth;
+    };
+    const FrozenTrieUnit free_unit = {0, NO_INDEX, NO_INDEX, 0, 0};
+    vector<FrozenTrieUnit> units;
+
+    //the free cells still worth trying as targets form a list in index order, so the search for a base never
+    //steps over used cells; a free cell passed over MAX_TRIES times is dropped from the list (it stays free),
+    //which bounds the search at MAX_TRIES visits per cell however dense the array gets
+    const unsigned char MAX_TRIES = 16;
+    vector<uint32_t> next_free;
+    vector<uint32_t> prev_free;
+    vector<unsigned char> tries;
+    uint32_t free_head = NO_INDEX;
+    uint32_t free_tail = NO_INDEX;
+    auto unlink = [&](uint32_t cell)
+    {
+        (prev_free[cell] == NO_INDEX ? free_head : next_free[prev_free[cell]]) = next_free[cell];
+        (next_free[cell] == NO_INDEX ? free_tail : prev_free[next_free[cell]]) = prev_free[cell];
+    };
+    auto grow = [&](size_t size)
+    {
+        for (size_t cell = units.size(); cell < size; cell++)
+        {
+            next_free.push_back(NO_INDEX);
+            prev_free.push_back(free_tail);
+            (free_tail == NO_INDEX ? free_head : next_free[free_tail]) = static_cast<uint32_t>(cell);
+            free_tail = static_cast<uint32_t>(cell);
+        }
+        units.resize(size, free_unit);
+        tries.resize(size, 0);
+    };
+    grow(256);
+    unlink(0);
+
+    vector<FrozenTrieWord> words;
+    vector<FrozenTriePair> pairs;
+    string text;
+
+    //depth first, so a chain of single-child states takes consecutive cells and a lookup walking it stays
+    //within a cache line or two
+    vector<Pending> pending = {Pending{0, root, 0}};
+    while (!pending.empty())
+    {
+        Pending current = pending.back();
+        pending.pop_back();
+        const TrieNode& node = arena.node(current.node);
+        unsigned char codes[256];
+        Pending targets[256];
+        size_t count = 0;
+        if (current.depth < node.label_length)
+        {
+            codes[count] = static_cast<unsigned char>(arena.label(node)[current.depth]);
+            targets[count++] = Pending{0, current.node, current.depth + 1};
+        }
+        else
+        {
+            if (node.entry != NO_INDEX)
+            {
+                units[current.cell].entry = static_cast<uint32_t>(words.size());
+                words.push_back(FrozenTrieWord{static_cast<uint32_t>(pairs.size()), static_cast<uint32_t>(entries[node.entry].size())});
+                for (const auto& state_population : entries[node.entry])
+                {
+                    if (text.size() + state_population.first.size() + state_population.second.size() > NO_INDEX)
+                    {
+                        throw length_error("FrozenTrie text must total less than 4 GiB.");
+                    }
+                    pairs.push_back(FrozenTriePair{static_cast<uint32_t>(text.size()), static_cast<uint32_t>(state_population.first.size()),
+                                                   static_cast<uint32_t>(text.size() + state_population.first.size()),
+                                                   static_cast<uint32_t>(state_population.second.size())});
+                    text += state_population.first;
+                    text += state_population.second;
+                }
+            }
+            arena.forEachChild(node, [&](char ch, uint32_t child)
+            {
+                codes[count] = static_cast<unsigned char>(ch);
+                targets[count++] = Pending{0, child, 1};
+            });
+        }
+        if (count == 0)
+        {
+            continue;
+        }
+
+        //the first listed free cell that can take codes[0] with every other code's cell free too; codes are
+        //sorted, so codes[0] is the smallest. Cells past the end of the array are all free.
+        size_t base = 0;
+        uint32_t cell = free_head;
+        while (true)
+        {
+            if (cell == NO_INDEX)
+            {
+                base = max<size_t>(units.size(), codes[0]) - codes[0];
+                break;
+            }
+            uint32_t next_cell = next_free[cell];
+            if (cell >= codes[0])
+            {
+                base = cell - codes[0];
+                size_t i = 1;
+                while (i < count && (base + codes[i] >= units.size() || units[base + codes[i]].check == NO_INDEX))
+                {
+                    i++;
+                }
+                if (i == count)
+                {
+                    break;
+                }
+            }
+            if (++tries[cell] == MAX_TRIES)
+            {
+                unlink(cell);
+            }
+            cell = next_cell;
+        }
+        if (base + 256 > NO_INDEX)
+        {
+            throw length_error("FrozenTrie supports fewer than 2^32 states.");
+        }
+        //keep 256 cells past every base so a lookup never needs a bounds check
+        if (base + 256 > units.size())
+        {
+            grow(base + 256);
+        }
+
+        units[current.cell].base = static_cast<uint32_t>(base);
+        units[current.cell].child = static_cast<uint16_t>(codes[0] + 1);
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t cell = static_cast<uint32_t>(base + codes[i]);
+            if (tries[cell] < MAX_TRIES)
+            {
+                unlink(cell);
+            }
+            units[cell].check = current.cell;
+            units[cell].sibling = i + 1 < count ? static_cast<uint16_t>(codes[i + 1] + 1) : 0;
+            targets[i].cell = cell;
+            pending.push_back(targets[i]);
+        }
+    }
+
+    //lay the sections out one after another, each 8-byte aligned, behind the header
+    FrozenTrieHeader header = {};
+    memcpy(header.magic, FROZEN_TRIE_MAGIC, sizeof(header.magic));
+    header.version = FROZEN_TRIE_VERSION;
+    header.unit_size = sizeof(FrozenTrieUnit);
+    header.unit_count = units.size();
+    header.word_count = words.size();
+    header.pair_count = pairs.size();
+    header.units_offset = sizeof(FrozenTrieHeader);
+    header.words_offset = header.units_offset + units.size() * sizeof(FrozenTrieUnit);
+    header.pairs_offset = header.words_offset + words.size() * sizeof(FrozenTrieWord);
+    header.text_offset = header.pairs_offset + pairs.size() * sizeof(FrozenTriePair);
+    header.image_size = header.text_offset + text.size();
+
+    vector<uint64_t> image((header.image_size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    char* bytes = reinterpret_cast<char*>(image.data());
+    memcpy(bytes, &header, sizeof(header));
+    copy(units.begin(), units.end(), reinterpret_cast<FrozenTrieUnit*>(bytes + header.units_offset));
+    copy(words.begin(), words.end(), reinterpret_cast<FrozenTrieWord*>(bytes + header.words_offset));
+    copy(pairs.begin(), pairs.end(), reinterpret_cast<FrozenTriePair*>(bytes + header.pairs_offset));
+    copy(text.begin(), text.end(), bytes + header.text_offset);
+    return FrozenTrie(move(image));
+}
+
+void Trie::rebuildFilter()
+{
+    filter.reset(max<size_t>(word_count * 2, 64));
+    vector<string> words;
+    string prefix;
+    findEntries(&arena.node(root), prefix, words);
+    for (const string& word : words)
+    {
+        filter.insert(hash<string_view>{}(word));
+    }
+}
+
+//adds the nodes below current, at the given depth in nodes, to the running totals
+void Trie::collectStats(uint32_t current, size_t depth, size_t& nodes, size_t& max_depth, size_t& word_depths) const
+{
+    nodes++;
+    max_depth = max(max_depth, depth);
+    if (arena.node(current).entry != NO_INDEX)
+    {
+        word_depths += depth;
+    }
+    arena.forEachChild(arena.node(current), [&](char, uint32_t child)
+    {
+        collectStats(child, depth + 1, nodes, max_depth, word_depths);
+    });
+}
+
+void Trie::printStats() const
+{
+    size_t nodes = 0;
+    size_t max_depth = 0;
+    size_t word_depths = 0;
+    collectStats(root, 0, nodes, max_depth, word_depths);
+
+    cout << "Trie Statistics:" << endl;
+    cout << "  Number of Words: " << word_count << endl;
+    cout << "  Number of Nodes: " << nodes << endl;
+    cout << "  Maximum Depth: " << max_depth << endl;
+    if (word_count > 0)
+    {
+        cout << "  Average Word Depth: " << (double)word_depths / word_count << endl;
+    }
+    cout << "  Node Size: " << sizeof(TrieNode) << " bytes" << endl;
+    cout << "  Arena Bytes: " << arena.memoryUsage() << endl;
+}
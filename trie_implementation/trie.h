@@ -1,51 +1,352 @@
 #ifndef TRIE_H
 #define TRIE_H
 
+#include<cstdint>
+#include<deque>
+#include<algorithm>
+#include<memory>
 #include<string>
+#include<string_view>
 #include<unordered_map>
 #include<vector>
+#include "../hashmap_implementation/BloomFilter.h"
+#include "frozen_trie.h"
 using namespace std;
 
+//marks a missing child, an empty child slot or a node that ends no word
+const uint32_t NO_INDEX = UINT32_MAX;
+//largest population of a subtree that holds no words
+const int64_t NO_POPULATION = INT64_MIN;
+
+//children of one TrieNode, kept in the smallest of four layouts that fits, as in an adaptive radix tree:
+//up to 4 sorted keys stored inline, up to 16 sorted keys compared all at once with SSE2, a 256-entry byte
+//index into 48 child slots, or a direct array of 256 children. Children are 32-bit node indices, and the
+//three larger layouts live in pools in the TrieArena, so this is plain data with no destructor.
+struct TrieChildren
+{
+    enum Kind : unsigned char { NODE4, NODE16, NODE48, NODE256 };
+
+    Kind kind;
+    unsigned short count;
+    union
+    {
+        struct
+        {
+            unsigned char keys[4];
+            uint32_t children[4];
+        } small;
+        //slot of the larger layout in the arena's pool for kind
+        uint32_t layout;
+    };
+};
+
+//the trie is path compressed: each node holds the label of the edge leading to it, so a run of single-child
+//characters is one node rather than one per character. Children are keyed by the first character of their label.
 class TrieNode
 {
 public:
-    unordered_map<char, TrieNode*> children;
-    bool end_word;
-    unordered_map<string, string> state_populations;
+    TrieChildren children;
+    //label of the edge from the parent, as a range of the arena's label bytes; only the root's is empty
+    uint32_t label_offset;
+    uint32_t label_length;
+    //index of the word's state -> population map, or NO_INDEX if no word ends here
+    uint32_t entry;
+    //number of words ending at or below this node, so counting the matches of a prefix stops at its node
+    uint32_t subtree_words;
+    //largest population stored at or below this node, so topK can skip subtrees that cannot make the cut
+    int64_t max_population;
+};
+
+//one result of Trie::topK: a word, one of its states and that state's population
+struct TrieMatch
+{
+    string word;
+    string state;
+    int64_t population;
+};
+
+//one result of Trie::searchFuzzy: a TrieMatch plus the word's edit distance from the query
+struct TrieFuzzyMatch
+{
+    string word;
+    string state;
+    int64_t population;
+    size_t distance;
+};
+
+//owns every node of a Trie. Nodes live in fixed-size chunks and refer to each other by 32-bit index, so
+//allocating one is a bump or a free-list pop, pointers to nodes stay valid as the arena grows, and since
+//nodes, labels and child layouts are all plain data, releasing the arena frees its chunks and pools
+//without visiting a single node.
+class TrieArena
+{
+public:
+    TrieArena();
+
+    TrieArena(const TrieArena&) = delete;
+    TrieArena& operator=(const TrieArena&) = delete;
+
+    //a node with no children, label or entry
+    uint32_t newNode();
+    //returns index, and its larger child layout if any, for reuse
+    void freeNode(uint32_t index);
+
+    TrieNode& node(uint32_t index)
+    {
+        return chunks[index >> CHUNK_BITS][index & (CHUNK_SIZE - 1)];
+    }
+    const TrieNode& node(uint32_t index) const
+    {
+        return chunks[index >> CHUNK_BITS][index & (CHUNK_SIZE - 1)];
+    }
+
+    //stores text as a label and points current at it; text must not point into the arena's own labels,
+    //since making room may move them
+    void setLabel(TrieNode& current, string_view text);
+    string_view label(const TrieNode& current) const
+    {
+        return string_view(labels.data() + current.label_offset, current.label_length);
+    }
 
-    TrieNode() : end_word(false) {}
+    //NO_INDEX if current has no child under ch
+    uint32_t findChild(const TrieNode& current, char ch) const;
+    //ch must not be present yet
+    void insertChild(TrieNode& current, char ch, uint32_t child);
+    //points the existing child under ch at child instead
+    void replaceChild(TrieNode& current, char ch, uint32_t child);
+    //returns the removed child, or NO_INDEX if ch was not present
+    uint32_t eraseChild(TrieNode& current, char ch);
 
-    ~TrieNode()
+    //calls fn(ch, child) for every child of current in byte order
+    template <typename Fn>
+    void forEachChild(const TrieNode& current, Fn fn) const
     {
-        for (auto& [key, value] : children)
+        const TrieChildren& children = current.children;
+        switch (children.kind)
         {
-            delete value;
+            case TrieChildren::NODE4:
+                for (size_t i = 0; i < children.count; i++)
+                {
+                    fn(static_cast<char>(children.small.keys[i]), children.small.children[i]);
+                }
+                break;
+            case TrieChildren::NODE16:
+            {
+                const Node16& layout = node16s[children.layout];
+                for (size_t i = 0; i < children.count; i++)
+                {
+                    fn(static_cast<char>(layout.keys[i]), layout.children[i]);
+                }
+                break;
+            }
+            case TrieChildren::NODE48:
+            {
+                const Node48& layout = node48s[children.layout];
+                for (size_t key = 0; key < 256; key++)
+                {
+                    if (layout.index[key] != 0)
+                    {
+                        fn(static_cast<char>(key), layout.children[layout.index[key] - 1]);
+                    }
+                }
+                break;
+            }
+            case TrieChildren::NODE256:
+            {
+                const Node256& layout = node256s[children.layout];
+                for (size_t key = 0; key < 256; key++)
+                {
+                    if (layout.children[key] != NO_INDEX)
+                    {
+                        fn(static_cast<char>(key), layout.children[key]);
+                    }
+                }
+                break;
+            }
         }
     }
+
+    //bytes held by the node chunks, labels and child layout pools
+    size_t memoryUsage() const;
+    //releases every chunk and pool
+    void clear();
+
+private:
+    static const unsigned CHUNK_BITS = 12;
+    static const uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+
+    struct Node16
+    {
+        unsigned char keys[16];
+        uint32_t children[16];
+    };
+    //index holds slot + 1 for each present key, 0 for absent ones; free slots hold NO_INDEX
+    struct Node48
+    {
+        unsigned char index[256];
+        uint32_t children[48];
+    };
+    struct Node256
+    {
+        uint32_t children[256];
+    };
+
+    vector<unique_ptr<TrieNode[]>> chunks;
+    uint32_t used_nodes;
+    vector<uint32_t> free_nodes;
+    vector<char> labels;
+    //bytes of labels still referenced by a node; the rest belong to replaced labels and freed nodes
+    size_t live_label_bytes;
+    vector<Node16> node16s;
+    vector<Node48> node48s;
+    vector<Node256> node256s;
+    vector<uint32_t> free_layouts[4];
+
+    uint32_t newLayout(TrieChildren::Kind kind);
+    void freeLayout(const TrieChildren& children);
+    //moves every child of current into a fresh layout of the given kind
+    void convert(TrieNode& current, TrieChildren::Kind target);
+    //copies the live labels into a fresh buffer, in their current order, and rewrites every node's offset
+    void compactLabels();
 };
 
 class Trie
 {
 private:
-    TrieNode* root;
+    TrieArena arena;
+    uint32_t root;
+    //state -> population maps of the stored words; a deque so that pointers handed out by findFull survive growth
+    deque<unordered_map<string, string>> entries;
+    vector<uint32_t> free_entries;
+    size_t word_count;
+    //optional filter over the hashes of every stored word, see setBloomFilter
+    BlockedBloomFilter filter;
 
-public:
-    Trie ()
+    //refills the filter from the stored words, sized for twice as many
+    void rebuildFilter();
+    //replaces node, which ends no word and has a single child, by that child with the two labels joined
+    void mergeWithChild(uint32_t parent, uint32_t node);
+    void collectStats(uint32_t current, size_t depth, size_t& nodes, size_t& max_depth, size_t& word_depths) const;
+    //searchFuzzy below current, whose spelling is word and whose edit distance rows are already filled in
+    void fuzzyVisit(uint32_t current, string& word, string_view target, uint32_t max_edits, vector<uint32_t>& rows,
+                    vector<TrieFuzzyMatch>& results) const;
+    //largest population among the states of the word ending at current, or NO_POPULATION
+    int64_t entryMaximum(const TrieNode& current) const;
+    //takes one off subtree_words on every node along word, which must be stored
+    void uncountWord(string_view word);
+    //recomputes max_population on the nodes along word, after a population there was lowered or removed
+    void refreshMaximums(string_view word);
+    //node reached by following prefix, which may end part way along its label, or NO_INDEX if no word starts
+    //with prefix; path, if given, is set to the full spelling of that node
+    uint32_t prefixNode(string_view prefix, string* path) const;
+
+    //calls fn(word, state_populations) for each word at or below current, spelled in word, in byte order; with
+    //after set, only for words that sort after *after. Returns false as soon as fn does.
+    template <typename Fn>
+    bool visitWords(uint32_t current, string& word, const string_view* after, Fn& fn) const
     {
-        root = new TrieNode();
+        if (after != nullptr)
+        {
+            size_t shared = min(word.size(), after->size());
+            int order = string_view(word).compare(0, shared, after->substr(0, shared));
+            if (order < 0)
+            {
+                //this subtree's words all sort before after
+                return true;
+            }
+            if (order > 0 || word.size() > after->size())
+            {
+                //and here they all sort after it
+                after = nullptr;
+            }
+        }
+
+        //while word is still a prefix of after, this node's own word does not sort after it
+        const TrieNode& node = arena.node(current);
+        if (after == nullptr && node.entry != NO_INDEX && !fn(string_view(word), entries[node.entry]))
+        {
+            return false;
+        }
+        bool keep_going = true;
+        arena.forEachChild(node, [&](char, uint32_t child)
+        {
+            if (keep_going)
+            {
+                size_t length = word.size();
+                word += arena.label(arena.node(child));
+                keep_going = visitWords(child, word, after, fn);
+                word.resize(length);
+            }
+        });
+        return keep_going;
     }
-    ~Trie()
+
+public:
+    Trie () : word_count(0)
     {
-        delete root;
+        root = arena.newNode();
     }
 
     void insert(const string& word, const string& state, const string& population);
     unordered_map<string, string> searchFull(string& word);
+    unordered_map<string, string> searchFull(string_view word);
+    unordered_map<string, string> searchFull(const char* word, size_t length);
+    //returns the stored state -> population map without copying it, or nullptr if word is missing
+    const unordered_map<string, string>* findFull(string_view word) const;
     vector<string> searchPrefix(string& prefix);
+    //one page of searchPrefix: the first limit matches in byte order, or with after, the first limit matches
+    //that sort after it. Passing the last word of a page as after resumes there, so a caller can page through
+    //a large subtree without holding all of it; a page shorter than limit is the last.
+    vector<string> searchPrefix(string_view prefix, size_t limit) const;
+    vector<string> searchPrefix(string_view prefix, size_t limit, string_view after) const;
+
+    //calls fn(word, state_populations) for every word starting with prefix, in the same order as searchPrefix,
+    //stopping early if fn returns false. word is only valid during the call. Nothing is copied per match.
+    //Returns false if fn stopped the walk.
+    template <typename Fn>
+    bool forEachWithPrefix(string_view prefix, Fn fn) const
+    {
+        string word;
+        uint32_t start = prefixNode(prefix, &word);
+        return start == NO_INDEX || visitWords(start, word, nullptr, fn);
+    }
+    //the same, for only the words that sort after after
+    template <typename Fn>
+    bool forEachWithPrefix(string_view prefix, string_view after, Fn fn) const
+    {
+        string word;
+        uint32_t start = prefixNode(prefix, &word);
+        return start == NO_INDEX || visitWords(start, word, &after, fn);
+    }
+    //the k most populous (word, state) pairs among words starting with prefix, largest first; populations
+    //that are not whole numbers count as 0. Runs a best-first search on the cached subtree maximums, so the
+    //work grows with k and the depth of the results rather than with the number of matches.
+    vector<TrieMatch> topK(string_view prefix, size_t k) const;
+    //number of words starting with prefix, read from the node the prefix reaches in O(|prefix|)
+    size_t countPrefix(string_view prefix) const;
+    //every (word, state) pair whose word is within max_edits insertions, deletions or substitutions of word,
+    //closest first and then most populous first. Computes the edit distance one character at a time down the
+    //trie, keeping only the band of the table that can stay within max_edits, and abandons an edge as soon
+    //as the whole band is over the bound, so only the near neighbourhood of word is visited.
+    vector<TrieFuzzyMatch> searchFuzzy(string_view word, size_t max_edits) const;
+    //removes word and all of its state entries, pruning nodes left without children; returns false if word is missing
+    bool remove(string_view word);
+    //removes every word, handing the arena's memory back in one go
+    void clear();
+    //compiles the current words into a read-only double-array trie; later changes to this trie do not reach it
+    FrozenTrie freeze() const;
+
+    //puts a blocked Bloom filter in front of exact searches so most missing words are rejected
+    //without walking the trie; bits_per_key of 0 removes it
+    void setBloomFilter(size_t bits_per_key);
+    //number of exact searches the filter rejected
+    size_t filterRejects() const;
 
     //helper functions
     void findEntries(TrieNode* current, string& prefix, vector<string>& results);
     bool isEmpty();
+    //prints word and node counts, depth and the memory taken by nodes
+    void printStats() const;
 };
 
 